@@ -14,6 +14,7 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "include/container/bijection.h"
 
@@ -37,6 +38,23 @@ int main() {
   const auto itr2 = b.range_find(2);
   cout << "(" << itr2->first << " " << itr2->second << ")" << endl;
 
+  Bijection<string, int> il {{"a", 1}, {"b", 2}, {"c", 2}};
+  cout << "Initializer list size: " << il.size() << " (should be 2)" << endl;
+
+  vector<pair<int, int>> vals;
+  for (int i = 0; i < 100000; ++i) {
+    vals.push_back(make_pair(i, 100000 - i));
+    vals.push_back(make_pair(i, 100000 - i));
+  }
+  Bijection<int, int> bulk;
+  cout << "Bulk load succeeded: " << bulk.assign(vals.begin(), vals.end(), true) << " (should be 1)" << endl;
+  cout << "Bulk load size: " << bulk.size() << " (should be 100000)" << endl;
+  cout << "Bulk lookup: " << bulk.range_find(1)->first << " (should be 99999)" << endl;
+
+  vals.push_back(make_pair(0, 7));
+  cout << "Bulk load conflict: " << bulk.assign(vals.begin(), vals.end(), true) << " (should be 0)" << endl;
+  cout << "Bulk load size: " << bulk.size() << " (should be 100000)" << endl;
+
   return 0;
 }
 
@@ -0,0 +1,100 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "include/container/flat_map.h"
+#include "include/container/maputil.h"
+
+using namespace cpputil;
+using namespace std;
+
+/** A key with no default constructor. */
+struct Id {
+  explicit Id(int i) : id(i) { }
+  bool operator<(const Id& rhs) const {
+    return id < rhs.id;
+  }
+  int id;
+};
+
+int main() {
+  CppUtilMap<FlatMap<int, char>> m;
+  for (int i = 4; i >= 0; --i) {
+    m[i] = 'a' + i;
+  }
+  m.freeze();
+
+  cout << "Pair iteration: [ ";
+  for (const auto& i : m) {
+    cout << "(" << i.first << "," << i.second << ") ";
+  }
+  cout << "]" << endl;
+
+  cout << "Key iteration: [ ";
+  for (auto i = m.key_begin(), ie = m.key_end(); i != ie; ++i) {
+    cout << *i << " ";
+  }
+  cout << "]" << endl;
+
+  cout << "Value iteration: [ ";
+  for (auto i = m.value_begin(), ie = m.value_end(); i != ie; ++i) {
+    cout << *i << " ";
+  }
+  cout << "]" << endl;
+
+  cout << "Frozen lookup: " << m.assert_at(3) << " (should be d)" << endl;
+
+  map<int, int> ref;
+  for (int i = 0; i < 10000; ++i) {
+    ref[rand() % 100000] = i;
+  }
+  FlatMap<int, int> flat(ref.begin(), ref.end());
+
+  size_t errors = 0;
+  for (int pass = 0; pass < 2; ++pass) {
+    for (int i = 0; i < 100000; ++i) {
+      const auto r = ref.find(i);
+      const auto f = flat.find(i);
+      if ((r == ref.end()) != (f == flat.end()) || (f != flat.end() && f->second != r->second)) {
+        ++errors;
+      }
+    }
+    flat.freeze();
+  }
+  cout << "Lookup mismatches: " << errors << " (should be 0)" << endl;
+
+  // Bulk insertion agrees with std::map: existing keys and then the first
+  // occurrence of a duplicate win
+  vector<pair<int, int>> more;
+  for (int i = 0; i < 10000; ++i) {
+    more.push_back(make_pair(rand() % 100000, -i));
+  }
+  ref.insert(more.begin(), more.end());
+  flat.insert(more.begin(), more.end());
+  cout << "Bulk insert agrees: " << (flat == FlatMap<int, int>(ref.begin(), ref.end())) <<
+       " (should be 1)" << endl;
+
+  FlatMap<Id, int> ids = {{Id(3), 30}, {Id(1), 10}, {Id(2), 20}};
+  ids.freeze();
+  cout << "Frozen Id lookup: " << ids.find(Id(2))->second << " (should be 20), ";
+  cout << "missing: " << (ids.find(Id(4)) == ids.end()) << " (should be 1)" << endl;
+
+  return 0;
+}
@@ -0,0 +1,130 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "include/container/hash_map.h"
+#include "include/container/hash_set.h"
+#include "include/container/maputil.h"
+#include "include/container/tokenizer.h"
+#include "include/memory/interner.h"
+
+using namespace cpputil;
+using namespace std;
+
+template <typename Fxn>
+double time_ms(Fxn f) {
+  const auto start = chrono::steady_clock::now();
+  f();
+  const auto end = chrono::steady_clock::now();
+  return chrono::duration<double, milli>(end - start).count();
+}
+
+template <typename Map, typename K>
+void bench(const string& name, const vector<K>& hits, const vector<K>& misses) {
+  Map m;
+  size_t found = 0;
+  const auto ins = time_ms([&] {
+    for (size_t i = 0; i < hits.size(); ++i) {
+      m[hits[i]] = i;
+    }
+  });
+  const auto hit = time_ms([&] {
+    for (const auto& k : hits) {
+      found += m.find(k) != m.end();
+    }
+  });
+  const auto miss = time_ms([&] {
+    for (const auto& k : misses) {
+      found += m.find(k) != m.end();
+    }
+  });
+  cout << setw(28) << left << name << setw(12) << right << fixed << setprecision(1) << ins
+       << setw(12) << hit << setw(12) << miss << "   (" << found << " found)" << endl;
+}
+
+template <typename K>
+void compare(const string& name, const vector<K>& hits, const vector<K>& misses) {
+  bench<unordered_map<K, size_t>>("unordered_map / " + name, hits, misses);
+  bench<HashMap<K, size_t>>("HashMap / " + name, hits, misses);
+}
+
+int main() {
+  // Correctness against std::unordered_map under random inserts and erases.
+  HashMap<int, int> h;
+  unordered_map<int, int> u;
+  mt19937 gen(0);
+  size_t errors = 0;
+  for (int i = 0; i < 200000; ++i) {
+    const int k = gen() % 5000;
+    if (gen() % 3 == 0) {
+      errors += h.erase(k) != u.erase(k);
+    } else {
+      h[k] = i;
+      u[k] = i;
+    }
+  }
+  for (const auto& p : u) {
+    errors += h.find(p.first) == h.end() || h.at(p.first) != p.second;
+  }
+  errors += h.size() != u.size();
+  cout << "Mismatches against unordered_map: " << errors << " (should be 0)" << endl;
+
+  // Drop-in use by other cpputil containers.
+  CppUtilMap<HashMap<int, char>> cm;
+  cm[1] = 'a';
+  cout << "CppUtilMap<HashMap>: " << cm.assert_at(1) << " (should be a)" << endl;
+
+  Tokenizer<string, uint64_t, HashMap<string, uint64_t>, HashMap<uint64_t, string>> t;
+  t.tokenize("Hello");
+  t.tokenize("world");
+  cout << "Tokenizer<HashMap>: " << t.untokenize(1)->first << " (should be world)" << endl;
+
+  Interner<string, NodeHashSet<string>> in;
+  const auto& s1 = in.intern("Hello");
+  for (int i = 0; i < 1000; ++i) {
+    in.intern(to_string(i));
+  }
+  cout << "Interner<NodeHashSet> stable: " << (&s1 == &in.intern("Hello")) << " (should be 1)"
+       << endl;
+
+  // Benchmark.
+  const size_t n = 1 << 20;
+  vector<uint64_t> seq, seq_miss, rnd, rnd_miss;
+  vector<string> str, str_miss;
+  for (size_t i = 0; i < n; ++i) {
+    seq.push_back(i);
+    seq_miss.push_back(i + n);
+    rnd.push_back((uint64_t(gen()) << 32) | gen());
+    rnd_miss.push_back((uint64_t(gen()) << 32) | gen());
+    str.push_back("token_" + to_string(rnd.back()));
+    str_miss.push_back("token_" + to_string(rnd_miss.back()));
+  }
+
+  cout << endl;
+  cout << setw(28) << left << "ms for 2^20 keys" << setw(12) << right << "insert" << setw(12)
+       << "hit" << setw(12) << "miss" << endl;
+  compare("sequential", seq, seq_miss);
+  compare("random", rnd, rnd_miss);
+  compare("string", str, str_miss);
+
+  return 0;
+}
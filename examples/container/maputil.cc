@@ -12,9 +12,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <iostream>
+#include <iterator>
 #include <map>
+#include <vector>
 
+#include "include/container/flat_map.h"
 #include "include/container/maputil.h"
 
 using namespace cpputil;
@@ -44,5 +50,45 @@ int main() {
   }
   cout << "]" << endl;
 
+  vector<int> keys;
+  m.keys_to(back_inserter(keys));
+  cout << "Exported keys: [ ";
+  for (auto k : keys) {
+    cout << k << " ";
+  }
+  cout << "]" << endl;
+
+  CppUtilMap<map<int, int>> big;
+  CppUtilMap<FlatMap<int, int>> flat;
+  for (int i = 0; i < 100000; ++i) {
+    big[i] = i;
+    flat[i] = i;
+  }
+
+  typedef map<int, int>::const_iterator itr_type;
+  atomic<long> sum(0);
+  big.parallel_for_each_chunk([&sum](itr_type first, itr_type last) {
+    long local = 0;
+    for (; first != last; ++first) {
+      local += first->second;
+    }
+    sum += local;
+  }, 4);
+  cout << "Chunked sum: " << sum << " (should be 4999950000)" << endl;
+
+  vector<int> values(flat.size());
+  flat.values_to(values.begin());
+  cout << "Random access key distance: " << (flat.key_end() - flat.key_begin())
+       << " (should be 100000)" << endl;
+  cout << "Contiguous value export: " << values[12345] << " (should be 12345)" << endl;
+
+  // Projections satisfy the whole random access interface
+  const auto first = flat.value_begin();
+  const auto mid = 50000 + first;
+  cout << "Random access comparisons: " << (mid > first && first <= mid && mid >= mid)
+       << " (should be 1)" << endl;
+  sort(flat.value_begin(), flat.value_end(), greater<int>());
+  cout << "Sorted values: " << *flat.value_begin() << " (should be 99999)" << endl;
+
   return 0;
 }
@@ -14,6 +14,7 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "include/container/tokenizer.h"
 
@@ -35,6 +36,16 @@ int main() {
     t.clear();
   }
 
+  vector<string> words {"the", "quick", "brown", "fox", "jumps", "over", "the", "lazy", "dog"};
+  Tokenizer<string> bulk(words.begin(), words.end(), true);
+  cout << "Bulk tokenized strings: (" << bulk.size() << ") [ ";
+  for (const auto& w : words) {
+    cout << "(" << w << " " << bulk.tokenize(w)->second << ") ";
+  }
+  cout << "]" << endl;
+  cout << "Bulk tokenizer memory: " << bulk.memory_usage() << " bytes, value load factor "
+       << bulk.value_hash_stats().load_factor << endl;
+
   return 0;
 }
 
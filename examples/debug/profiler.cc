@@ -0,0 +1,75 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#define DEBUG_PROFILER
+
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "include/debug/profiler.h"
+#include "include/system/cycle_clock.h"
+
+using namespace cpputil;
+using namespace std;
+
+double work(size_t n) {
+  CPPUTIL_PROFILE("work");
+  double res = 0;
+  for (size_t i = 0; i < n; ++i) {
+    res += sqrt(double(i));
+  }
+  return res;
+}
+
+double outer() {
+  CPPUTIL_PROFILE("outer");
+  double res = 0;
+  for (size_t i = 0; i < 10; ++i) {
+    res += work(1000);
+  }
+  return res;
+}
+
+int main() {
+  cout << "invariant tsc = " << CycleClock::invariant_tsc() << endl;
+  cout << "ns per tick = " << CycleClock::ns_per_tick() << endl;
+  cout << endl;
+
+  vector<thread> ts;
+  vector<double> results(4);
+  for (size_t t = 0; t < 4; ++t) {
+    ts.emplace_back([&results, t] {
+      for (size_t i = 0; i < 100; ++i) {
+        results[t] += outer();
+      }
+    });
+  }
+  for (auto& t : ts) {
+    t.join();
+  }
+
+  // The cost of an empty region
+  for (size_t i = 0; i < 100000; ++i) {
+    CPPUTIL_PROFILE("empty");
+  }
+
+  Profiler::report();
+  cout << endl;
+  cout << "outer count = " << Profiler::stats(Profiler::region("outer")).size() << " (should be 400)" << endl;
+  cout << "work count = " << Profiler::stats(Profiler::region("work")).size() << " (should be 4000)" << endl;
+
+  return 0;
+}
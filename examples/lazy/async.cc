@@ -0,0 +1,85 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "include/lazy/async_thunk.h"
+#include "include/lazy/future.h"
+#include "include/lazy/thread_pool.h"
+
+using namespace cpputil;
+using namespace std;
+
+int slow(int x) {
+  sleep(1);
+  return x;
+}
+
+int main() {
+  ThreadPool pool(4);
+
+  // Futures and continuations
+  auto f = make_async(pool, slow, 20);
+  auto g = f.then(pool, [](int x) {
+    return x + 1;
+  }).then(pool, [](int x) {
+    return to_string(x * 2);
+  });
+  cout << "chained = " << g.get() << " (should be 42)" << endl;
+
+  // Exceptions skip continuations and surface at get()
+  auto bad = make_async(pool, [] {
+    throw runtime_error("failed");
+    return 0;
+  }).then(pool, [](int x) {
+    return x + 1;
+  });
+  try {
+    bad.get();
+  } catch (const runtime_error& e) {
+    cout << "caught = " << e.what() << endl;
+  }
+
+  // Independent async thunks evaluate in parallel once started
+  auto a = make_async_thunk(pool, slow, 1);
+  auto b = make_async_thunk(pool, slow, 2);
+  auto c = make_async_thunk(pool, slow, 3);
+  cout << "started = " << a.started() << " (should be 0)" << endl;
+  a.start();
+  b.start();
+  c.start();
+  cout << "sum = " << a.get() + b.get() + c.get() << " (should be 6, after about 1s)" << endl;
+
+  // Tasks which wait on other tasks run queued work instead of blocking
+  auto outer = make_async(pool, [&pool] {
+    vector<Future<int>> inner;
+    for (int i = 0; i < 8; ++i) {
+      inner.push_back(make_async(pool, [](int x) {
+        return x * x;
+      }, i));
+    }
+    int sum = 0;
+    for (auto& i : inner) {
+      sum += i.get();
+    }
+    return sum;
+  });
+  cout << "nested = " << outer.get() << " (should be 140)" << endl;
+
+  return 0;
+}
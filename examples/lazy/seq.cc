@@ -0,0 +1,81 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cctype>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "include/container/bit_vector.h"
+#include "include/container/tokenizer.h"
+#include "include/lazy/seq.h"
+
+using namespace cpputil;
+using namespace std;
+
+int main() {
+  vector<int> v {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+
+  // One fused loop; no intermediate vectors are built
+  cout << "squares of odds: ";
+  auto odd = [](int x) {
+    return x % 2 == 1;
+  };
+  auto square = [](int x) {
+    return x * x;
+  };
+  for (auto x : make_seq(v).filter(odd).map(square)) {
+    cout << x << " ";
+  }
+  cout << "(should be 1 9 25 49 81)" << endl;
+
+  const auto sum = make_seq(v).take(4).reduce(0, [](int a, int b) {
+    return a + b;
+  });
+  cout << "sum of first four = " << sum << " (should be 10)" << endl;
+
+  cout << "chunks of three: ";
+  make_seq(v).chunk(3).for_each([](const vector<int>& c) {
+    cout << "[" << c.size() << "] ";
+  });
+  cout << "(should be [3] [3] [3] [1])" << endl;
+
+  // Tokenizer ranges and BitString set-bit indices are sequences too
+  vector<string> words {"the", "quick", "brown", "fox", "jumps", "over", "the", "lazy", "dog"};
+  Tokenizer<string> tok(words.begin(), words.end());
+
+  BitVector long_words(tok.size());
+  make_seq(tok).filter([](const pair<string, uint64_t>& p) {
+    return p.first.size() > 3;
+  }).for_each([&long_words](const pair<string, uint64_t>& p) {
+    long_words[p.second] = true;
+  });
+
+  cout << "long words by token: ";
+  make_seq(long_words.set_bit_index_begin(), long_words.set_bit_index_end()).map([&tok](size_t i) {
+    auto w = tok.untokenize(i)->first;
+    for (auto& c : w) {
+      c = toupper(c);
+    }
+    return w;
+  }).zip(make_seq(v)).for_each([](const pair<string, int>& p) {
+    cout << p.second << ":" << p.first << " ";
+  });
+  cout << "(should be 1:QUICK 2:BROWN 3:JUMPS 4:OVER 5:LAZY)" << endl;
+
+  cout << "set bits = " << make_seq(long_words.set_bit_index_begin(), long_words.set_bit_index_end()).count();
+  cout << " (should be 5)" << endl;
+
+  return 0;
+}
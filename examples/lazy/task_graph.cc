@@ -0,0 +1,97 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include/lazy/task_graph.h"
+#include "include/lazy/thread_pool.h"
+
+using namespace cpputil;
+using namespace std;
+
+// Stands in for a startup stage which mostly waits on I/O
+void stage(size_t ms) {
+  this_thread::sleep_for(chrono::milliseconds(ms));
+}
+
+double seconds(const function<void()>& f) {
+  const auto start = chrono::steady_clock::now();
+  f();
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+  // A startup pipeline: the tokenizer needs the config, the index needs the
+  // tokenizer and the tables, and the tables and caches are independent
+  TaskGraph g;
+  const auto config = g.add([] {
+    stage(100);
+  });
+  const auto tokenizer = g.add([] {
+    stage(200);
+  }, {config});
+  const auto tables = g.add([] {
+    stage(150);
+  });
+  vector<TaskGraph::task_id> caches;
+  for (size_t i = 0; i < 4; ++i) {
+    caches.push_back(g.add([] {
+      stage(100);
+    }));
+  }
+  auto deps = caches;
+  deps.push_back(tokenizer);
+  deps.push_back(tables);
+  g.add([] {
+    stage(50);
+  }, deps);
+
+  const auto sequential = seconds([] {
+    for (auto ms : {100, 200, 150, 100, 100, 100, 100, 50}) {
+      stage(ms);
+    }
+  });
+  ThreadPool pool(4);
+  const auto parallel = seconds([&g, &pool] {
+    g.run(pool);
+  });
+
+  cout << "tasks = " << g.size() << endl;
+  cout << "sequential = " << sequential << "s (should be about 0.9s)" << endl;
+  cout << "parallel = " << parallel << "s (should be about 0.35s)" << endl;
+  cout << "speedup = " << sequential / parallel << "x" << endl;
+
+  // A failing task stops its dependents and is reported by run()
+  TaskGraph bad;
+  bool ran = false;
+  const auto fail = bad.add([] {
+    throw runtime_error("failed");
+  });
+  bad.add([&ran] {
+    ran = true;
+  }, {fail});
+  try {
+    bad.run(pool);
+  } catch (const runtime_error& e) {
+    cout << "caught = " << e.what() << ", dependent ran = " << ran << " (should be 0)" << endl;
+  }
+  cout << "bad dependency = " << (long) bad.add([] { }, {10}) << " (should be -1)" << endl;
+
+  return 0;
+}
@@ -13,7 +13,10 @@
 // limitations under the License.
 
 #include <iostream>
+#include <memory>
+#include <thread>
 #include <unistd.h>
+#include <vector>
 
 #include "include/lazy/thunk.h"
 
@@ -29,6 +32,36 @@ int main() {
   auto t1 = make_thunk(slow, 3);
   cout << "Hello world!" << endl;
   cout << t1 << endl;
+  cout << "(again, without waiting) " << t1 << endl;
+
+  // Concurrent uses evaluate the function exactly once
+  size_t calls = 0;
+  auto t2 = make_thunk([&calls](int x) {
+    ++calls;
+    sleep(1);
+    return x * 2;
+  }, 21);
+  vector<thread> ts;
+  vector<int> results(4);
+  for (size_t i = 0; i < 4; ++i) {
+    ts.emplace_back([&t2, &results, i] {
+      results[i] = t2;
+    });
+  }
+  for (auto& t : ts) {
+    t.join();
+  }
+  cout << "results = " << results[0] << " " << results[1] << " " << results[2] << " " << results[3];
+  cout << " after " << calls << " call(s)" << endl;
+
+  // Arguments are released once the result is available
+  auto big = make_shared<vector<int>>(1000000, 1);
+  auto t3 = make_thunk([](shared_ptr<vector<int>> v) {
+    return v->size();
+  }, shared_ptr<vector<int>>(big));
+  cout << "owners before = " << big.use_count() << endl;
+  cout << "size = " << t3.get() << endl;
+  cout << "owners after = " << big.use_count() << endl;
 
   return 0;
 }
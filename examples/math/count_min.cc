@@ -0,0 +1,101 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "include/math/count_min.h"
+
+using namespace cpputil;
+using namespace std;
+
+int main() {
+  // A skewed stream in which a few elements are heavy hitters
+  mt19937 gen(0);
+  geometric_distribution<int> dist(0.0002);
+  vector<int> stream(1000000);
+  unordered_map<int, int64_t> exact;
+  for (auto& s : stream) {
+    s = dist(gen);
+    exact[s]++;
+  }
+
+  const auto width = CountMin<int>::width_for(0.001);
+  const auto depth = CountMin<int>::depth_for(0.01);
+  cout << "width = " << width << " (rounded up to " << CountMin<int>(width, depth).width() << "), depth = " << depth << endl;
+
+  CountMin<int> plain(width, depth, false);
+  CountMin<int> conservative(width, depth);
+  vector<CountMin<int>> parts(4, CountMin<int>(width, depth));
+  CountSketch<int> cs(width, 5);
+  for (size_t i = 0; i < stream.size(); ++i) {
+    plain.push_back(stream[i]);
+    conservative.push_back(stream[i]);
+    parts[i % 4].push_back(stream[i]);
+    cs.push_back(stream[i]);
+  }
+  CountMin<int> merged(width, depth);
+  for (const auto& p : parts) {
+    merged.merge(p);
+  }
+
+  double plain_err = 0;
+  double conservative_err = 0;
+  double cs_err = 0;
+  for (const auto& e : exact) {
+    plain_err += plain.count(e.first) - e.second;
+    conservative_err += conservative.count(e.first) - e.second;
+    cs_err += abs(cs.count(e.first) - e.second);
+  }
+  cout << "count(0) = " << conservative.count(0) << " (exact " << exact[0] << ")" << endl;
+  cout << "mean overcount, plain = " << plain_err / exact.size() << endl;
+  cout << "mean overcount, conservative = " << conservative_err / exact.size() << endl;
+  cout << "mean absolute error, count sketch = " << cs_err / exact.size() << endl;
+  cout << "merged total = " << merged.total() << " (should be " << stream.size() << ")" << endl;
+  cout << "merged count(0) = " << merged.count(0) << " (at least " << exact[0] << ")" << endl;
+
+  // Count sketches support decrements
+  cs.push_back(0, -exact[0]);
+  cout << "count sketch after removal = " << cs.count(0) << " (should be 0, up to the error above)" << endl;
+
+  // Round trips through the binary and text formats
+  stringstream binary;
+  conservative.write(binary);
+  CountMin<int> from_binary(1, 1);
+  from_binary.read(binary);
+  cout << "binary bytes = " << binary.str().size() << " (" << conservative.memory_usage() << " in memory)" << endl;
+  cout << "binary round trip = " << from_binary.count(0) << ", " << from_binary.total();
+  cout << " (should be " << conservative.count(0) << ", " << conservative.total() << ")" << endl;
+
+  // A corrupt shape fails without allocating it
+  stringstream corrupt(string("\x80\x80\x80\x80\x10\x40", 6));
+  from_binary.read(corrupt);
+  cout << "corrupt fails = " << corrupt.fail() << ", unchanged = "
+       << (from_binary.count(0) == conservative.count(0)) << " (should be 1, 1)" << endl;
+
+  CountSketch<string> small(4, 3);
+  small.push_back("hello", 3);
+  stringstream text;
+  TextWriter<CountSketch<string>>()(text, small);
+  CountSketch<string> from_text(1, 1);
+  TextReader<CountSketch<string>>()(text, from_text);
+  cout << "text = " << text.str() << endl;
+  cout << "text round trip = " << from_text.count("hello") << " (should be 3)" << endl;
+
+  return 0;
+}
@@ -0,0 +1,117 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "include/math/histogram.h"
+
+using namespace cpputil;
+using namespace std;
+
+int main() {
+  mt19937 gen(0);
+  lognormal_distribution<double> dist(7.0, 1.0);
+  vector<uint64_t> samples(1 << 20);
+  for (auto& s : samples) {
+    s = dist(gen);
+  }
+  auto sorted = samples;
+  sort(sorted.begin(), sorted.end());
+
+  Histogram<> h;
+  for (auto s : samples) {
+    h.record(s);
+  }
+  cout << "count = " << h.count() << " (should be " << samples.size() << ")" << endl;
+  for (auto q : {0.5, 0.99, 0.999}) {
+    const auto exact = sorted[q * sorted.size() - 1];
+    cout << "q = " << q << ": " << h.quantile(q) << " (exact " << exact << ", relative error ";
+    cout << (h.quantile(q) - exact) / (double) exact << ")" << endl;
+  }
+  cout << "min = " << h.min() << " (should be " << sorted.front() << ")" << endl;
+  cout << "max = " << h.max() << " (should be at least " << sorted.back() << ")" << endl;
+
+  // Quantiles use rank ceil(q * count())
+  Histogram<> small3;
+  for (uint64_t v : {10, 20, 30}) {
+    small3.record(v);
+  }
+  cout << "q = 0.4 of {10, 20, 30} = " << small3.quantile(0.4) << " (should be 20)" << endl;
+  Histogram<> hundred;
+  for (uint64_t v = 1; v <= 100; ++v) {
+    hundred.record(v);
+  }
+  cout << "q = 0.07 of 1..100 = " << hundred.quantile(0.07) << " (should be 7)" << endl;
+
+  // The top bucket reaches UINT64_MAX
+  Histogram<> extremes;
+  extremes.record(0);
+  extremes.record(UINT64_MAX);
+  cout << "buckets = " << Histogram<>::bucket_count() << " (index of UINT64_MAX is "
+       << Histogram<>::index(UINT64_MAX) << ")" << endl;
+  cout << "quantile(1) = " << extremes.quantile(1) << " (should be " << UINT64_MAX << ")" << endl;
+  cout << "max = " << extremes.max() << ", bucket lower bound = "
+       << Histogram<>::lower_bound(Histogram<>::index(UINT64_MAX)) << endl;
+  ShardedHistogram<> top;
+  top.record(UINT64_MAX);
+  cout << "sharded quantile(1) = " << top.snapshot().quantile(1) << endl;
+
+  // Four threads record into a shared histogram
+  ShardedHistogram<> sh;
+  vector<thread> ts;
+  vector<double> ns(4);
+  for (size_t t = 0; t < 4; ++t) {
+    ts.emplace_back([&sh, &samples, &ns, t] {
+      const auto start = chrono::high_resolution_clock::now();
+      for (size_t i = t; i < samples.size(); i += 4) {
+        sh.record(samples[i]);
+      }
+      ns[t] = chrono::duration<double, nano>(chrono::high_resolution_clock::now() - start).count();
+    });
+  }
+  for (auto& t : ts) {
+    t.join();
+  }
+  const auto snap = sh.snapshot();
+  cout << "sharded count = " << snap.count() << " (should be " << h.count() << ")" << endl;
+  cout << "sharded p99 = " << snap.quantile(0.99) << " (should be " << h.quantile(0.99) << ")" << endl;
+  cout << "ns per record = " << ns[0] / (samples.size() / 4) << endl;
+
+  // Round trips through the text and binary formats
+  Histogram<> small;
+  for (uint64_t v : {1, 2, 2, 300, 300000}) {
+    small.record(v);
+  }
+  stringstream text;
+  TextWriter<Histogram<>>()(text, small);
+  cout << "text = " << text.str() << endl;
+  Histogram<> from_text;
+  TextReader<Histogram<>>()(text, from_text);
+  cout << "text round trip p99 = " << from_text.quantile(0.99) << " (should be " << small.quantile(0.99) << ")" << endl;
+
+  stringstream binary;
+  h.write(binary);
+  Histogram<> from_binary;
+  from_binary.read(binary);
+  cout << "binary bytes = " << binary.str().size() << endl;
+  cout << "binary round trip mean = " << from_binary.mean() << " (should be " << h.mean() << ")" << endl;
+
+  return 0;
+}
@@ -0,0 +1,89 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "include/math/hyper_log_log.h"
+
+using namespace cpputil;
+using namespace std;
+
+int main() {
+  // Each thread-local sketch sees an overlapping quarter of the stream
+  vector<HyperLogLog<uint64_t>> parts(4);
+  HyperLogLog<uint64_t> whole;
+  unordered_set<uint64_t> exact;
+  for (uint64_t i = 0; i < 1000000; ++i) {
+    const auto x = (i * 7919) % 600000;
+    parts[i % 4].push_back(x);
+    whole.push_back(x);
+    exact.insert(x);
+  }
+
+  HyperLogLog<uint64_t> merged;
+  for (const auto& p : parts) {
+    merged.merge(p);
+  }
+  cout << "exact = " << exact.size() << endl;
+  cout << "whole = " << whole.estimate() << " (relative error " << whole.relative_error() << ")" << endl;
+  cout << "merged = " << merged.estimate() << " (should be " << whole.estimate() << ")" << endl;
+  cout << "mismatched merge = " << merged.merge(HyperLogLog<uint64_t>(10)) << " (should be 0)" << endl;
+
+  // Small cardinalities fall back to linear counting
+  HyperLogLog<string> small;
+  for (auto s : {"a", "b", "c", "a", "b", "a"}) {
+    small.push_back(s);
+  }
+  cout << "small = " << small.estimate() << " (should be about 3)" << endl;
+
+  // Round trips through the binary and text formats
+  stringstream binary;
+  whole.write(binary);
+  HyperLogLog<uint64_t> from_binary(4);
+  from_binary.read(binary);
+  cout << "binary bytes = " << binary.str().size() << " (" << whole.memory_usage() << " in memory)" << endl;
+  cout << "binary round trip = " << from_binary.estimate() << " (should be " << whole.estimate() << ")" << endl;
+
+  stringstream text;
+  TextWriter<HyperLogLog<string>>()(text, small);
+  HyperLogLog<string> from_text(4);
+  TextReader<HyperLogLog<string>>()(text, from_text);
+  cout << "text round trip = " << from_text.estimate() << " (should be " << small.estimate() << ")" << endl;
+
+  // Registers larger than any rank are rejected
+  auto big = text.str();
+  big.replace(big.rfind('0'), 1, "300");
+  stringstream bad(big);
+  TextReader<HyperLogLog<string>>()(bad, from_text);
+  cout << "bad register fails = " << bad.fail() << ", unchanged = "
+       << (from_text.estimate() == small.estimate()) << " (should be 1, 1)" << endl;
+
+  // Merging and estimation are vectorized
+  const auto start = chrono::high_resolution_clock::now();
+  double sum = 0;
+  for (size_t i = 0; i < 1000; ++i) {
+    merged.merge(whole);
+    sum += merged.estimate();
+  }
+  const auto us = chrono::duration<double, micro>(chrono::high_resolution_clock::now() - start).count();
+  cout << "us per merge + estimate = " << us / 1000 << " (" << sum / 1000 << ")" << endl;
+
+  return 0;
+}
@@ -12,9 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <chrono>
 #include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
 
 #include "include/math/online_stats.h"
+#include "include/math/parallel_stats.h"
 
 using namespace cpputil;
 using namespace std;
@@ -39,5 +44,108 @@ int main() {
   cout << "mean = " << os.mean() << " (should be " << mean << ")" << endl;
   cout << "sig2 = " << os.variance() << " (should be " << var << ")" << endl;
 
+  OnlineStats<float> lo, hi;
+  for (size_t i = 0; i < 10; ++i) {
+    (i < 4 ? lo : hi).push_back(i);
+  }
+  lo.merge(hi);
+  cout << "merged mean = " << lo.mean() << " (should be " << mean << ")" << endl;
+  cout << "merged sig2 = " << lo.variance() << " (should be " << var << ")" << endl;
+
+  // Integer samples are accumulated without truncating the mean
+  OnlineStats<int> is;
+  for (auto i : {1, 2}) {
+    is.push_back(i);
+  }
+  cout << "int mean = " << is.mean() << " (should be 1.5)" << endl;
+
+  const vector<int> lo_hi {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+  mt19937 gen(0);
+  normal_distribution<double> dist(1e6, 3.0);
+  vector<double> samples(1 << 22);
+  for (auto& s : samples) {
+    s = dist(gen);
+  }
+  OnlineStats<double> seq;
+  for (auto s : samples) {
+    seq.push_back(s);
+  }
+
+  typedef chrono::high_resolution_clock clock;
+  auto start = clock::now();
+  OnlineStats<double> timed;
+  for (auto s : samples) {
+    timed.push_back(s);
+  }
+  const auto seq_time = chrono::duration<double>(clock::now() - start).count();
+  start = clock::now();
+  OnlineStats<double> batch;
+  batch.push_back(samples.data(), samples.size());
+  const auto batch_time = chrono::duration<double>(clock::now() - start).count();
+  cout << "batch mean = " << batch.mean() << " (should be " << seq.mean() << ")" << endl;
+  cout << "batch sig2 = " << batch.variance() << " (should be " << seq.variance() << ")" << endl;
+  cout << "batch speedup = " << seq_time / batch_time << "x (sig2 = " << timed.variance() << ")" << endl;
+
+  OnlineStats<float> ints;
+  ints.push_back(lo_hi.begin(), lo_hi.end());
+  cout << "range mean = " << ints.mean() << " (should be " << mean << ")" << endl;
+  cout << "range sig2 = " << ints.variance() << " (should be " << var << ")" << endl;
+
+  // Higher moments from the batched path agree with the per-sample path
+  exponential_distribution<double> skewed(1.0);
+  vector<double> exps(1 << 16);
+  for (auto& e : exps) {
+    e = skewed(gen);
+  }
+  OnlineStats<double> one, many;
+  for (auto e : exps) {
+    one.push_back(e);
+  }
+  many.push_back(exps.begin(), exps.end());
+  cout << "min = " << many.min() << " (should be " << one.min() << ")" << endl;
+  cout << "max = " << many.max() << " (should be " << one.max() << ")" << endl;
+  cout << "skewness = " << many.skewness() << " (should be " << one.skewness() << ", about 2)" << endl;
+  cout << "kurtosis = " << many.kurtosis() << " (should be " << one.kurtosis() << ", about 6)" << endl;
+
+  const auto par = parallel_online_stats(samples.begin(), samples.end(), 8);
+  cout << "parallel mean = " << par.mean() << " (should be " << seq.mean() << ")" << endl;
+  cout << "parallel sig2 = " << par.variance() << " (should be " << seq.variance() << ")" << endl;
+
+  ShardedOnlineStats<double> sharded;
+  vector<thread> ts;
+  for (size_t t = 0; t < 4; ++t) {
+    ts.emplace_back([&sharded, &samples, t] {
+      for (size_t i = t; i < samples.size(); i += 4) {
+        sharded.push_back(samples[i]);
+      }
+    });
+  }
+  for (auto& t : ts) {
+    t.join();
+  }
+  const auto agg = sharded.aggregate();
+  cout << "sharded size = " << agg.size() << " (should be " << seq.size() << ")" << endl;
+  cout << "sharded sig2 = " << agg.variance() << " (should be " << seq.variance() << ")" << endl;
+
+  // Samples that haven't been published yet are still seen by readers, and
+  // a thread may alternate between instances without losing its shards
+  ShardedOnlineStats<double> a, b;
+  size_t sizes_decreased = 0;
+  thread writer([&a, &b] {
+    for (size_t i = 0; i < 100001; ++i) {
+      (i % 2 == 0 ? a : b).push_back(i);
+    }
+  });
+  for (size_t last = 0, i = 0; i < 1000; ++i) {
+    const auto size = a.aggregate().size();
+    sizes_decreased += size < last;
+    last = size;
+  }
+  writer.join();
+  cout << "partial batch sizes = " << a.aggregate().size() << " " << b.aggregate().size()
+       << " (should be 50001 50000)" << endl;
+  cout << "concurrent reads decreased = " << sizes_decreased << " (should be 0)" << endl;
+
   return 0;
 }
@@ -0,0 +1,107 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "include/math/t_digest.h"
+
+using namespace cpputil;
+using namespace std;
+
+// Returns the fraction of sorted samples which are at most x
+double exact_cdf(const vector<double>& sorted, double x) {
+  return (double)(upper_bound(sorted.begin(), sorted.end(), x) - sorted.begin()) / sorted.size();
+}
+
+int main() {
+  // Latency-like samples: log-normal with a heavy right tail
+  mt19937 gen(0);
+  lognormal_distribution<double> dist(7.0, 1.0);
+  vector<double> samples(1 << 21);
+  for (auto& s : samples) {
+    s = dist(gen);
+  }
+  auto sorted = samples;
+  sort(sorted.begin(), sorted.end());
+
+  const double qs[] = {0.5, 0.99, 0.999};
+
+  cout << "Memory and rank error trade-offs (" << samples.size() << " samples)" << endl;
+  cout << endl;
+  cout << "Rank errors are shown as measured / bound, in percent" << endl;
+  cout << endl;
+  cout << setw(8) << "delta" << setw(10) << "bytes" << setw(10) << "cents" << setw(10) << "ns/push";
+  for (auto q : qs) {
+    cout << setw(12) << "err@" << setw(6) << left << q << right;
+  }
+  cout << endl;
+  cout << fixed;
+
+  for (double delta : {25.0, 50.0, 100.0, 200.0, 400.0}) {
+    const auto start = chrono::high_resolution_clock::now();
+    TDigest<double> td(delta);
+    td.push_back(samples.data(), samples.size());
+    const auto cents = td.centroids();
+    const auto ns = chrono::duration<double, nano>(chrono::high_resolution_clock::now() - start).count();
+
+    cout << setw(8) << setprecision(0) << delta << setw(10) << td.memory_usage() << setw(10) << cents;
+    cout << setw(10) << setprecision(1) << ns / samples.size();
+    for (auto q : qs) {
+      const auto err = fabs(exact_cdf(sorted, td.quantile(q)) - q);
+      cout << setw(10) << setprecision(4) << 100 * err << " / " << setw(5) << setprecision(3)
+           << 100 * TDigest<double>::rank_error_bound(q, delta);
+    }
+    cout << endl;
+  }
+  cout << endl;
+  cout.unsetf(ios::floatfield);
+  cout << setprecision(6);
+
+  // Collect on four independent sketches and merge them
+  TDigest<double> whole;
+  vector<TDigest<double>> parts(4);
+  for (size_t i = 0; i < samples.size(); ++i) {
+    whole.push_back(samples[i]);
+    parts[i % 4].push_back(samples[i]);
+  }
+  TDigest<double> merged;
+  for (const auto& p : parts) {
+    merged.merge(p);
+  }
+
+  cout << "merged size = " << merged.size() << " (should be " << whole.size() << ")" << endl;
+  for (auto q : qs) {
+    cout << "q = " << q << ": exact = " << sorted[q * sorted.size()];
+    cout << ", whole = " << whole.quantile(q) << ", merged = " << merged.quantile(q) << endl;
+  }
+  cout << "cdf(p99) = " << merged.cdf(sorted[0.99 * sorted.size()]) << " (should be about 0.99)" << endl;
+
+  // Merging keeps the exact extrema, not those of the centroids
+  TDigest<double> range;
+  for (size_t i = 0; i < 1000000; ++i) {
+    range.push_back(i);
+  }
+  TDigest<double> empty;
+  empty.merge(range);
+  cout << "merged min = " << empty.min() << ", max = " << empty.max() << " (should be 0 and 999999)" << endl;
+  cout << "merged quantile(0) = " << empty.quantile(0) << ", quantile(1) = " << empty.quantile(1) << endl;
+  cout << "compression for 0.5% error = " << TDigest<double>::compression_for(0.005) << endl;
+
+  return 0;
+}
@@ -0,0 +1,66 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "include/math/online_stats.h"
+#include "include/math/windowed_stats.h"
+
+using namespace cpputil;
+using namespace std;
+
+int main() {
+  mt19937 gen(0);
+  uniform_int_distribution<int> dist(0, 1000);
+  vector<int> samples(100000);
+  for (auto& s : samples) {
+    s = dist(gen);
+  }
+
+  // Compare the sliding window against a from-scratch pass over the last 100
+  WindowedStats<int> ws(100);
+  for (auto s : samples) {
+    ws.push_back(s);
+  }
+  OnlineStats<int> last;
+  for (auto i = samples.end() - 100; i != samples.end(); ++i) {
+    last.push_back(*i);
+  }
+  cout << "window size = " << ws.size() << " (should be 100)" << endl;
+  cout << "window mean = " << ws.mean() << " (should be " << last.mean() << ")" << endl;
+  cout << "window sig2 = " << ws.variance() << " (should be " << last.variance() << ")" << endl;
+  cout << "window min = " << ws.min() << " (should be " << last.min() << ")" << endl;
+  cout << "window max = " << ws.max() << " (should be " << last.max() << ")" << endl;
+
+  // A partially filled window behaves like OnlineStats
+  WindowedStats<double> partial(10);
+  for (auto s : {3.0, 1.0, 2.0}) {
+    partial.push_back(s);
+  }
+  cout << "partial mean = " << partial.mean() << " (should be 2)" << endl;
+  cout << "partial min = " << partial.min() << " (should be 1)" << endl;
+
+  // An EWMA converges to the mean of a step change
+  EwmaStats<double> ewma(0.1);
+  for (size_t i = 0; i < 200; ++i) {
+    ewma.push_back(i < 100 ? 0 : 10);
+  }
+  cout << "ewma mean = " << ewma.mean() << " (should be about 10)" << endl;
+  cout << "ewma sig2 = " << ewma.variance() << " (should be about 0)" << endl;
+
+  return 0;
+}
@@ -15,6 +15,7 @@
 #include <iostream>
 #include <string>
 
+#include "include/container/hash_set.h"
 #include "include/memory/interner.h"
 
 using namespace cpputil;
@@ -49,5 +50,22 @@ int main() {
     i.clear();
   }
 
+  Interner<string> std_strings;
+  Interner<string, NodeHashSet<string>> swiss_strings;
+  for (int n = 0; n < 10000; ++n) {
+    const auto s = "a moderately long string number " + to_string(n);
+    std_strings.intern(s);
+    swiss_strings.intern(s);
+  }
+  for (int n = 0; n < 2; ++n) {
+    const auto stats = n == 0 ? std_strings.hash_stats() : swiss_strings.hash_stats();
+    cout << (n == 0 ? "unordered_set:" : "NodeHashSet:  ")
+         << " bytes = " << (n == 0 ? std_strings.memory_usage() : swiss_strings.memory_usage())
+         << " load = " << stats.load_factor
+         << " mean probe = " << stats.mean_probe_length
+         << " max probe = " << stats.max_probe_length
+         << " rehashes = " << stats.rehashes << endl;
+  }
+
   return 0;
 }
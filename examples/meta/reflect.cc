@@ -0,0 +1,92 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "include/meta/is_reflected.h"
+#include "include/serialize/binary_reader.h"
+#include "include/serialize/binary_writer.h"
+#include "include/serialize/text_reader.h"
+#include "include/serialize/text_writer.h"
+
+using namespace cpputil;
+using namespace std;
+
+struct Point {
+  int x;
+  int y;
+  CPPUTIL_REFLECT(x, y)
+
+  bool operator==(const Point& rhs) const {
+    return cpputil_fields() == rhs.cpputil_fields();
+  }
+};
+
+struct Record {
+  string name;
+  Point origin;
+  vector<Point> path;
+  map<string, double> tags;
+  CPPUTIL_REFLECT(name, origin, path, tags)
+
+  bool operator==(const Record& rhs) const {
+    return cpputil_fields() == rhs.cpputil_fields();
+  }
+};
+
+int main() {
+  static_assert(is_reflected<Point>::value, "Point should be reflected");
+  static_assert(!is_reflected<pair<int, int>>::value, "pair should not be reflected");
+
+  Record r;
+  r.name = "route";
+  r.origin = Point {1, 2};
+  r.path = {{3, 4}, {5, -6}};
+  r.tags = {{"length", 7.5}, {"cost", 2}};
+
+  // Text: a struct looks like a tuple of its fields
+  stringstream ts;
+  TextWriter<Record>()(ts, r);
+  cout << ts.str() << endl;
+
+  Record r2;
+  TextReader<Record>()(ts, r2);
+  cout << "text round trip = " << (ts && r == r2) << endl;
+
+  // Binary: fields are written in declaration order
+  stringstream bs;
+  BinaryWriter<vector<Record>>()(bs, vector<Record>(3, r));
+  vector<Record> v;
+  BinaryReader<vector<Record>>()(bs, v);
+  cout << "binary round trip = " << (bs && v == vector<Record>(3, r)) << endl;
+
+  // A struct has the same encoding alone and inside a container
+  stringstream one;
+  BinaryWriter<Point>()(one, Point {5, -6});
+  stringstream many;
+  BinaryWriter<vector<Point>>()(many, vector<Point>(2, Point {5, -6}));
+  cout << "element encoding = " << (many.str() == "\x02" + one.str() + one.str()) << endl;
+
+  // Malformed text sets failbit
+  stringstream bad("{ 1 x }");
+  Point p;
+  TextReader<Point>()(bad, p);
+  cout << "malformed = " << bad.fail() << endl;
+
+  return 0;
+}
@@ -0,0 +1,125 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "include/meta/has_unique_representation.h"
+#include "include/serialize/binary_reader.h"
+#include "include/serialize/binary_writer.h"
+#include "include/serialize/text_reader.h"
+#include "include/serialize/text_writer.h"
+
+using namespace cpputil;
+using namespace std;
+using namespace std::chrono;
+
+template <typename T>
+bool round_trip(const T& t) {
+  stringstream ss;
+  BinaryWriter<T>()(ss, t);
+  T t2 = T();
+  BinaryReader<T>()(ss, t2);
+  return ss && t == t2;
+}
+
+template <typename Writer, typename Reader, typename T>
+double time(const T& t) {
+  const auto begin = steady_clock::now();
+
+  stringstream ss;
+  Writer()(ss, t);
+  T t2 = T();
+  Reader()(ss, t2);
+
+  const auto end = steady_clock::now();
+  return duration_cast<duration<double>>(end - begin).count();
+}
+
+int main() {
+  // Every dispatch category round trips
+  cout << "int = " << round_trip(-12345) << endl;
+  cout << "double = " << round_trip(3.25) << endl;
+  cout << "string = " << round_trip(string("Hello world")) << endl;
+  cout << "pair = " << round_trip(make_pair(1u, string("one"))) << endl;
+  cout << "tuple = " << round_trip(make_tuple('c', 2l, string("two"))) << endl;
+  cout << "vector<double> = " << round_trip(vector<double> {1.0, 2.0, 3.0}) << endl;
+  cout << "vector<bool> = " << round_trip(vector<bool> {true, false, true}) << endl;
+  cout << "array<int, 3> = " << round_trip(array<int, 3> {{7, 8, 9}}) << endl;
+  cout << "list<string> = " << round_trip(list<string> {"a", "bb", "ccc"}) << endl;
+  cout << "set<int> = " << round_trip(set<int> {3, 1, 2}) << endl;
+  cout << "map<string, vector<int>> = " <<
+       round_trip(map<string, vector<int>> {{"x", {1}}, {"y", {2, 3}}}) << endl;
+  cout << "long elements = " <<
+       round_trip(vector<pair<int, string>> {{1, "a"}, {2, string(100000, 'b')}, {3, "c"}}) << endl;
+  cout << "(all should be 1)" << endl;
+
+  // Truncated input sets failbit
+  stringstream ss;
+  BinaryWriter<vector<int64_t>>()(ss, vector<int64_t>(4, 1));
+  stringstream truncated(ss.str().substr(0, 3));
+  vector<int64_t> v;
+  BinaryReader<vector<int64_t>>()(truncated, v);
+  cout << "truncated fails = " << truncated.fail() << " (should be 1)" << endl;
+
+  stringstream short_string(string("\x0a") + "abc");
+  string str;
+  BinaryReader<string>()(short_string, str);
+  cout << "truncated string fails = " << short_string.fail() << " (should be 1)" << endl;
+
+  // Only elements without padding bytes are written raw
+  static_assert(has_unique_representation<array<uint16_t, 3>>::value, "array should be raw");
+  static_assert(!has_unique_representation<pair<char, int>>::value, "pair should not be raw");
+  static_assert(!has_unique_representation<long double>::value, "long double should not be raw");
+  stringstream raw;
+  BinaryWriter<vector<array<uint16_t, 3>>>()(raw, {{{1, 2, 3}}, {{4, 5, 6}}});
+  cout << "raw array bytes = " << raw.str().size() << " (should be 13)" << endl;
+  cout << "vector<array<uint16_t, 3>> = " <<
+       round_trip(vector<array<uint16_t, 3>> {{{1, 2, 3}}, {{4, 5, 6}}}) << " (should be 1)" << endl;
+
+  // Compare against the text path
+  vector<pair<uint64_t, string>> records;
+  vector<double> doubles;
+  for (size_t i = 0; i < 1000000; ++i) {
+    records.push_back(make_pair(rand() % 100000, to_string(rand())));
+    doubles.push_back(rand() / 1024.0);
+  }
+
+  typedef decltype(records) R;
+  const auto rt = time<TextWriter<R>, TextReader<R>>(records);
+  const auto rb = time<BinaryWriter<R>, BinaryReader<R>>(records);
+  cout << "vector<pair<uint64_t, string>>: text " << rt << "s, binary " << rb << "s, speedup " <<
+       (rt / rb) << "x" << endl;
+
+  cout << "binary round trip = " << round_trip(records) << " (should be 1)" << endl;
+
+  typedef decltype(doubles) D;
+  const auto dt = time<TextWriter<D>, TextReader<D>>(doubles);
+  const auto db = time<BinaryWriter<D>, BinaryReader<D>>(doubles);
+  cout << "vector<double>: text " << dt << "s, binary " << db << "s, speedup " <<
+       (dt / db) << "x" << endl;
+  cout << "binary round trip = " << round_trip(doubles) << " (should be 1)" << endl;
+
+  return 0;
+}
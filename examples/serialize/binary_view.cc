@@ -0,0 +1,146 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "include/serialize/binary_reader.h"
+#include "include/serialize/binary_view.h"
+
+using namespace cpputil;
+using namespace std;
+using namespace std::chrono;
+
+typedef tuple<map<uint64_t, double>, vector<string>, set<int>, map<string, vector<int>>> Table;
+
+int main() {
+  Table t;
+  for (size_t i = 0; i < 1000000; ++i) {
+    get<0>(t)[i * 7] = i / 2.0;
+    get<1>(t).push_back(to_string(i));
+  }
+  get<2>(t) = {3, 1, 2};
+  get<3>(t) = {{"odd", {1, 3, 5}}, {"even", {0, 2, 4}}};
+
+  const string path = "/tmp/binary_view.bin";
+  ofstream ofs(path);
+  BinaryFile<Table>::write(ofs, t);
+  ofs.close();
+
+  // Loading copies and parses everything
+  auto begin = steady_clock::now();
+  Table t2;
+  ifstream ifs(path);
+  ifs.ignore(24);
+  BinaryReader<Table>()(ifs, t2);
+  auto end = steady_clock::now();
+  cout << "BinaryReader load: " << duration_cast<duration<double>>(end - begin).count() << "s" << endl;
+
+  // Opening only maps the file
+  begin = steady_clock::now();
+  BinaryFile<Table> file(path);
+  const auto v = file.view();
+  end = steady_clock::now();
+  cout << "BinaryFile open: " << duration_cast<duration<double>>(end - begin).count() << "s" << endl;
+
+  const auto m = v.get<0>();
+  cout << "size = " << m.size() << " (should be 1000000)" << endl;
+  cout << "m[700] = " << m.at(700) << " (should be 50)" << endl;
+  cout << "contains 701 = " << m.contains(701) << " (should be 0)" << endl;
+
+  const auto strs = v.get<1>();
+  cout << "strs[12345] = " << strs[12345].str() << " (should be 12345)" << endl;
+  cout << "strs[42] == \"42\" = " << (strs[42] == "42") << " (should be 1)" << endl;
+
+  cout << "set = ";
+  for (auto i : v.get<2>()) {
+    cout << i << " ";
+  }
+  cout << "(should be 1 2 3)" << endl;
+
+  const auto evens = v.get<3>().at("even");
+  cout << "even = ";
+  for (auto i : evens) {
+    cout << i << " ";
+  }
+  cout << "(should be 0 2 4)" << endl;
+
+  cout << "valid = " << v.valid() << " (should be 1)" << endl;
+  cout << "verify = " << file.verify() << " (should be 1)" << endl;
+
+  // Corruption is caught by the checksum, truncation by bounds checks
+  fstream fs(path);
+  fs.seekp(1000);
+  fs.put('!');
+  fs.close();
+  BinaryFile<Table> corrupt(path);
+  cout << "corrupt verify = " << corrupt.verify() << " (should be 0)" << endl;
+
+  const auto truncated = BinaryView<Table>(file.view().data(), file.view().data() + 1000);
+  cout << "truncated valid = " << truncated.valid() << " (should be 0)" << endl;
+  cout << "truncated strs.size() = " << truncated.get<1>().size() << " (should be 0)" << endl;
+
+  // Sorted containers of strings are binary searched through their key index
+  map<string, uint64_t> words;
+  for (uint64_t i = 0; i < 100000; ++i) {
+    words[to_string(i * 3)] = i;
+  }
+  stringstream ws;
+  BinaryWriter<decltype(words)>()(ws, words);
+  const auto wbuf = ws.str();
+  const BinaryView<decltype(words)> wv(wbuf.data(), wbuf.data() + wbuf.size());
+  size_t word_errors = 0;
+  for (uint64_t i = 0; i < 300000; ++i) {
+    const auto w = words.find(to_string(i));
+    const auto j = wv.find(to_string(i));
+    word_errors += w == words.end() ? j != wv.size() : j == wv.size() || wv.value(j) != w->second;
+  }
+  cout << "string key mismatches = " << word_errors << " (should be 0)" << endl;
+  cout << "string keys valid = " << (wv.next() == wbuf.data() + wbuf.size()) << " (should be 1)" << endl;
+
+  const set<string> names {"carol", "alice", "bob"};
+  stringstream ns;
+  BinaryWriter<set<string>>()(ns, names);
+  const auto nbuf = ns.str();
+  const BinaryView<set<string>> nv(nbuf.data(), nbuf.data() + nbuf.size());
+  cout << "set<string> = " << nv.key(0).str() << " " << nv.contains("bob") << " " << nv.contains("dave")
+       << " (should be alice 1 0)" << endl;
+
+  const unordered_map<string, int> hashed {{"x", 1}, {"y", 2}};
+  stringstream hs;
+  BinaryWriter<decltype(hashed)>()(hs, hashed);
+  const auto hbuf = hs.str();
+  const BinaryView<decltype(hashed)> hv(hbuf.data(), hbuf.data() + hbuf.size());
+  cout << "unordered at(y) = " << hv.at("y") << " (should be 2)" << endl;
+
+  // Accessors of a truncated string return an empty range
+  const string hello = "\x05hello";
+  const BinaryView<string> cut(hello.data(), hello.data() + 3);
+  cout << "cut[0] = " << int(cut[0]) << " (should be 0)" << endl;
+  cout << "cut range = " << (cut.begin() == cut.end()) << " (should be 1)" << endl;
+  cout << "cut str = \"" << string(cut.begin(), cut.end()) << "\" (should be \"\")" << endl;
+
+  remove(path.c_str());
+  return 0;
+}
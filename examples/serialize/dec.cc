@@ -0,0 +1,124 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "include/io/fail.h"
+#include "include/serialize/dec_reader.h"
+#include "include/serialize/dec_writer.h"
+
+using namespace cpputil;
+using namespace std;
+using namespace std::chrono;
+
+template <typename T>
+void bench(const string& name, const string& text, size_t n) {
+  istringstream is1(text);
+  auto begin = steady_clock::now();
+  T sum1 = 0;
+  for (size_t i = 0; i < n; ++i) {
+    T t;
+    is1 >> t;
+    sum1 += t;
+  }
+  const auto slow = duration_cast<duration<double>>(steady_clock::now() - begin).count();
+
+  istringstream is2(text);
+  begin = steady_clock::now();
+  T sum2 = 0;
+  for (size_t i = 0; i < n; ++i) {
+    T t;
+    DecReader<T>()(is2, t);
+    sum2 += t;
+  }
+  const auto fast = duration_cast<duration<double>>(steady_clock::now() - begin).count();
+
+  cout << name << ": operator>> " << slow << "s, DecReader " << fast << "s, speedup " <<
+       (slow / fast) << "x, same sums = " << (sum1 == sum2) << endl;
+}
+
+template <typename T>
+void bench_write(const string& name, const vector<T>& ts) {
+  ostringstream os1;
+  auto begin = steady_clock::now();
+  for (auto t : ts) {
+    const auto f = os1.flags(ios::dec);
+    os1 << t;
+    os1.flags(f);
+    os1.put(' ');
+  }
+  const auto slow = duration_cast<duration<double>>(steady_clock::now() - begin).count();
+
+  ostringstream os2;
+  begin = steady_clock::now();
+  for (auto t : ts) {
+    DecWriter<T>()(os2, t);
+    os2.put(' ');
+  }
+  const auto fast = duration_cast<duration<double>>(steady_clock::now() - begin).count();
+
+  cout << name << ": operator<< " << slow << "s, DecWriter " << fast << "s, speedup " <<
+       (slow / fast) << "x, same output = " << (os1.str() == os2.str()) << endl;
+}
+
+int main() {
+  // The stream state matches operator>>
+  istringstream is("42 -7 oops 99999999999");
+  int i = 0;
+  DecReader<int>()(is, i);
+  cout << "i = " << i << " (should be 42)" << endl;
+  DecReader<int>()(is, i);
+  cout << "i = " << i << " (should be -7)" << endl;
+  DecReader<int>()(is, i);
+  cout << "failed(is) = " << failed(is) << ", i = " << i << " (should be 1, 0)" << endl;
+  is.clear();
+  is.ignore(5);
+  DecReader<int>()(is, i);
+  cout << "failed(is) = " << failed(is) << ", i = " << i << " (should be 1, 2147483647)" << endl;
+  cout << "eof(is) = " << is.eof() << " (should be 1)" << endl;
+
+  // Numbers can also be parsed straight out of a buffer
+  const string buf = "3.25e2,";
+  double d = 0;
+  const auto p = DecReader<double>::parse(buf.data(), buf.data() + buf.size(), d);
+  cout << "d = " << d << ", stopped at '" << *p << "' (should be 325, ',')" << endl;
+
+  const size_t n = 1000000;
+  vector<long> ls;
+  vector<double> ds;
+  for (size_t j = 0; j < n; ++j) {
+    ls.push_back(rand() - RAND_MAX / 2);
+    ds.push_back(rand() / 1000.0);
+  }
+  bench_write("long", ls);
+  bench_write("double", ds);
+
+  ostringstream ints;
+  ostringstream doubles;
+  for (size_t j = 0; j < n; ++j) {
+    DecWriter<long>()(ints, ls[j]);
+    ints << " ";
+    DecWriter<double>()(doubles, ds[j]);
+    doubles << " ";
+  }
+  bench<long>("long", ints.str(), n);
+  bench<double>("double", doubles.str(), n);
+
+  return 0;
+}
@@ -12,14 +12,19 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cctype>
+#include <chrono>
 #include <iostream>
 #include <sstream>
+#include <stdint.h>
+#include <vector>
 
 #include "include/serialize/hex_reader.h"
 #include "include/serialize/hex_writer.h"
 
 using namespace cpputil;
 using namespace std;
+using namespace std::chrono;
 
 template <typename T>
 void check(T t) {
@@ -50,5 +55,70 @@ int main() {
   check(f);
   check(d);
 
+  // Dumping a large bit vector a word at a time
+  vector<uint64_t> words;
+  for (uint64_t i = 0; i < 1000000; ++i) {
+    words.push_back(i * 0x9e3779b97f4a7c15ull);
+  }
+
+  stringstream slow;
+  auto begin = steady_clock::now();
+  for (auto w : words) {
+    const auto f = slow.flags(ios::hex);
+    for (size_t i = 16; i > 0; --i) {
+      if (i < 16 && i % 8 == 0) {
+        slow << " ";
+      }
+      slow << ((((uint8_t*) &w)[(i - 1) / 2] >> (i % 2 == 0 ? 4 : 0)) & 0x0f);
+    }
+    slow.flags(f);
+  }
+  const auto slow_time = duration_cast<duration<double>>(steady_clock::now() - begin).count();
+
+  stringstream fast;
+  begin = steady_clock::now();
+  for (auto w : words) {
+    HexWriter<uint64_t>()(fast, w);
+  }
+  const auto fast_time = duration_cast<duration<double>>(steady_clock::now() - begin).count();
+
+  cout << "nibble at a time " << slow_time << "s, HexWriter " << fast_time << "s, speedup " <<
+       (slow_time / fast_time) << "x, same output = " << (slow.str() == fast.str()) << endl;
+
+  // And reading it back
+  begin = steady_clock::now();
+  auto same = true;
+  for (auto w : words) {
+    uint64_t u = 0;
+    for (size_t i = 16; i > 0; --i) {
+      if (i < 16 && i % 8 == 0) {
+        slow.get();
+      }
+      const auto c = slow.get();
+      u |= uint64_t(isdigit(c) ? c - '0' : c - 'a' + 10) << (4 * (i - 1));
+    }
+    same &= u == w;
+  }
+  const auto slow_read = duration_cast<duration<double>>(steady_clock::now() - begin).count();
+
+  begin = steady_clock::now();
+  for (auto w : words) {
+    uint64_t u = 0;
+    HexReader<uint64_t>()(fast, u);
+    same &= u == w;
+  }
+  const auto fast_read = duration_cast<duration<double>>(steady_clock::now() - begin).count();
+
+  cout << "get() at a time " << slow_read << "s, HexReader " << fast_read << "s, speedup " <<
+       (slow_read / fast_read) << "x, " << (17 * words.size() / fast_read / 1e6) << " MB/s, same values = " << same << endl;
+
+  // Errors consume up to and including the bad character
+  stringstream bad("01234567 89abcdeg 01234567 89abcdef");
+  HexReader<uint64_t>()(bad, u64);
+  cout << "bad digit fails = " << bad.fail() << " (should be 1)" << endl;
+  bad.clear();
+  HexReader<uint64_t>()(bad, u64);
+  cout << "next fails = " << bad.fail() << " (should be 1, it starts with the separator)" << endl;
+
   return 0;
 }
@@ -0,0 +1,121 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "include/lazy/thread_pool.h"
+#include "include/serialize/line_reader.h"
+#include "include/serialize/parallel_line_reader.h"
+#include "include/serialize/text_reader.h"
+#include "include/serialize/text_writer.h"
+#include "include/system/mapped_file.h"
+
+using namespace cpputil;
+using namespace std;
+
+typedef vector<int> Row;
+
+template <typename F>
+double time_ms(F f) {
+  const auto start = chrono::steady_clock::now();
+  f();
+  const auto end = chrono::steady_clock::now();
+  return chrono::duration<double, milli>(end - start).count();
+}
+
+int main() {
+  // Write a file of one Row per line
+  const string path = "/tmp/cpputil_parallel_line.txt";
+  const size_t n = 500000;
+  {
+    ofstream ofs(path);
+    for (size_t i = 0; i < n; ++i) {
+      Row r;
+      for (size_t j = 0; j < i % 8; ++j) {
+        r.push_back(i * 8 + j);
+      }
+      TextWriter<Row>()(ofs, r);
+      ofs << endl;
+    }
+  }
+
+  // Read it back one line at a time
+  vector<Row> expected;
+  const auto serial = time_ms([&path, &expected] {
+    ifstream ifs(path);
+    string line;
+    Row r;
+    while (LineReader<>()(ifs, line), ifs) {
+      istringstream iss(line);
+      r.clear();
+      TextReader<Row>()(iss, r);
+      expected.push_back(r);
+    }
+  });
+
+  ThreadPool pool;
+  ParallelLineReader<> plr(pool, 1 << 16);
+  MappedFile mf(path);
+  mf.sequential();
+
+  // Count lines concurrently
+  atomic<size_t> lines(0);
+  plr.for_each(mf.begin(), mf.end(), [&lines](const char*, const char*) {
+    lines.fetch_add(1, memory_order_relaxed);
+  });
+  cout << "for_each saw " << lines << " of " << n << " lines" << endl;
+
+  // Parse on the workers, preserving input order
+  vector<Row> ordered;
+  bool ok = false;
+  const auto parallel = time_ms([&plr, &mf, &ordered, &ok] {
+    ok = plr.read<Row>(mf.begin(), mf.end(), [&ordered](Row& r) {
+      ordered.push_back(std::move(r));
+    });
+  });
+  cout << "ordered read " << (ok && ordered == expected ? "matches" : "DOES NOT MATCH")
+       << " the serial read" << endl;
+  cout << "serial:   " << serial << " ms" << endl;
+  cout << "parallel: " << parallel << " ms with " << pool.size() << " threads" << endl;
+
+  // Unordered delivery sees the same lines, in some block order
+  size_t total = 0;
+  plr.read<Row>(mf.begin(), mf.end(), [&total](Row& r) {
+    total += r.size();
+  }, false);
+  size_t expected_total = 0;
+  for (const auto& r : expected) {
+    expected_total += r.size();
+  }
+  cout << "unordered read " << (total == expected_total ? "matches" : "DOES NOT MATCH")
+       << " the serial read" << endl;
+
+  // A malformed line is skipped and reported
+  const string bad = "{ 1 2 }\n{ 3 x }\n{ 4 }";
+  vector<Row> good;
+  ok = plr.read<Row>(bad.data(), bad.data() + bad.size(), [&good](Row& r) {
+    good.push_back(r);
+  });
+  cout << "malformed input: ok = " << ok << ", " << good.size() << " good lines" << endl;
+
+  remove(path.c_str());
+  return 0;
+}
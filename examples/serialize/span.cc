@@ -0,0 +1,345 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <iostream>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "include/algorithm/radix_sort.h"
+#include "include/container/bit_array.h"
+#include "include/container/bit_vector.h"
+#include "include/container/range_set.h"
+#include "include/serialize/range.h"
+#include "include/serialize/span_reader.h"
+#include "include/serialize/span_writer.h"
+
+using namespace cpputil;
+using namespace std;
+
+typedef Range<uint32_t, 0, 100000000> Indices;
+
+template <typename T>
+string write(const T& t) {
+  ostringstream oss;
+  SpanWriter<T, Indices>()(oss, t);
+  return oss.str();
+}
+
+template <typename R, typename T>
+string write_as(const T& t) {
+  ostringstream oss;
+  SpanWriter<T, R>()(oss, t);
+  return oss.str();
+}
+
+/** The original encoder: copy, sort, and then emit each maximal run of
+    consecutive values. Duplicates start a new run. */
+template <typename T>
+string reference_write(vector<T> v) {
+  sort(v.begin(), v.end());
+  ostringstream oss;
+  oss << "{";
+  for (size_t i = 0; i < v.size();) {
+    size_t j = i + 1;
+    while (j < v.size() && v[j] == v[j - 1] + 1) {
+      ++j;
+    }
+    if (j - i > 2) {
+      oss << " " << v[i] << " ... " << v[j - 1];
+    } else if (j - i == 2) {
+      oss << " " << v[i] << " " << v[i + 1];
+    } else {
+      oss << " " << v[i];
+    }
+    i = j;
+  }
+  oss << " }";
+  return oss.str();
+}
+
+/** Random keys with duplicates, drawn from a range narrow enough that radix
+    passes are skipped, or wide enough that none are. */
+template <typename T>
+vector<T> random_keys(mt19937& gen) {
+  const auto n = gen() % 3 == 0 ? gen() % 8 : gen() % 2000;
+  const auto wide = gen() % 2 == 0;
+  vector<T> v;
+  for (size_t i = 0; i < n; ++i) {
+    // Unsigned arithmetic, so that wrapping around is well defined
+    const uint64_t base = wide ? uint64_t(gen()) << 32 | gen() : uint64_t(0) - 16;
+    v.push_back(T(base + gen() % 64));
+    if (gen() % 4 == 0) {
+      v.push_back(v.back());
+    }
+  }
+  if (gen() % 2 == 0) {
+    sort(v.begin(), v.end());
+  }
+  return v;
+}
+
+template <typename T>
+T read(const string& s) {
+  istringstream iss(s);
+  T t;
+  SpanReader<T, Indices>()(iss, t);
+  return t;
+}
+
+template <typename T, typename R>
+T read_as(const string& s, bool& ok) {
+  istringstream iss(s);
+  T t;
+  SpanReader<T, R>()(iss, t);
+  ok = !iss.fail();
+  return t;
+}
+
+template <typename F>
+double time_ms(F f) {
+  const auto start = chrono::steady_clock::now();
+  f();
+  const auto end = chrono::steady_clock::now();
+  return chrono::duration<double, milli>(end - start).count();
+}
+
+int main() {
+  // Runs of three or more collapse; order and containers don't matter
+  const vector<uint32_t> v = {9, 1, 2, 3, 4, 7, 6, 12};
+  cout << write(v) << endl;
+  cout << write(set<uint32_t>(v.begin(), v.end())) << endl;
+  cout << write(vector<uint32_t>()) << endl;
+
+  BitVector bv(200);
+  for (auto i : v) {
+    bv[i] = true;
+  }
+  for (size_t i = 60; i < 140; ++i) {
+    bv[i] = true;
+  }
+  cout << write(bv) << endl;
+
+  // Radix sort agrees with std::sort
+  mt19937 gen(0);
+  vector<int64_t> keys(100000);
+  for (auto& k : keys) {
+    k = int64_t(gen()) - int64_t(gen());
+  }
+  auto sorted = keys;
+  sort(sorted.begin(), sorted.end());
+  radix_sort(keys.begin(), keys.end());
+  cout << "radix_sort = " << (keys == sorted) << endl;
+
+  // The writer matches the original sort-then-encode path, including on
+  // empty input, duplicates and signed keys
+  auto sequences = true;
+  for (size_t i = 0; i < 20000 && sequences; ++i) {
+    const auto s64 = random_keys<int64_t>(gen);
+    const auto u32 = random_keys<uint32_t>(gen);
+    const auto s8 = random_keys<int8_t>(gen);
+    auto r64 = s64;
+    radix_sort(r64.begin(), r64.end());
+    auto sorted64 = s64;
+    sort(sorted64.begin(), sorted64.end());
+    sequences = r64 == sorted64 &&
+                write_as<Range<int64_t, INT64_MIN, INT64_MAX>>(s64) == reference_write(s64) &&
+                write_as<Indices>(u32) == reference_write(u32) &&
+                write_as<Indices>(multiset<uint32_t>(u32.begin(), u32.end())) == reference_write(u32) &&
+                write_as<Range<int, -128, 127>>(vector<int>(s8.begin(), s8.end())) ==
+                reference_write(vector<int>(s8.begin(), s8.end()));
+  }
+  cout << "writer matches reference = " << sequences << endl;
+
+  // Runs of set bits that start, end and span anywhere within the words
+  auto bit_strings = true;
+  for (size_t i = 0; i < 20000 && bit_strings; ++i) {
+    BitVector bits(gen() % 700);
+    vector<uint32_t> indices;
+    for (size_t b = gen() % 8; b < bits.num_bits(); b += 1 + gen() % 130) {
+      for (size_t e = min<size_t>(bits.num_bits(), b + 1 + gen() % 200); b < e; ++b) {
+        bits[b] = true;
+        indices.push_back(b);
+      }
+    }
+    bit_strings = write(bits) == reference_write(indices);
+  }
+  cout << "BitVector matches reference = " << bit_strings << endl;
+
+  // Ten million indices, mostly in runs, encoded from each representation
+  const size_t n = 10000000;
+  vector<uint32_t> in_order;
+  BitVector bits(2 * n);
+  for (size_t i = 0; i < 2 * n && in_order.size() < n; ++i) {
+    if ((i / 1000) % 2 == 0 || gen() % 8 == 0) {
+      in_order.push_back(i);
+      bits[i] = true;
+    }
+  }
+  auto shuffled = in_order;
+  shuffle(shuffled.begin(), shuffled.end(), gen);
+
+  string a, b, c;
+  const auto ta = time_ms([&a, &in_order] {
+    a = write(in_order);
+  });
+  const auto tb = time_ms([&b, &shuffled] {
+    b = write(shuffled);
+  });
+  const auto tc = time_ms([&c, &bits] {
+    c = write(bits);
+  });
+  cout << "encodings agree = " << (a == b && b == c) << endl;
+  cout << "sorted:    " << ta << " ms" << endl;
+  cout << "shuffled:  " << tb << " ms" << endl;
+  cout << "BitVector: " << tc << " ms" << endl;
+
+  // Every target decodes the same span
+  const auto s = write(v);
+  cout << "vector = " << (write(read<vector<uint32_t>>(s)) == s) << endl;
+  cout << "set = " << (write(read<set<uint32_t>>(s)) == s) << endl;
+  cout << "BitVector = " << (write(read<BitVector>(s)) == s) << endl;
+  cout << "BitArray = " << (write(read<BitArray<64>>(s)) == s) << endl;
+  cout << "RangeSet = " << (write(read<RangeSet<uint32_t>>(s)) == s) << endl;
+
+  // Values that don't fit in a BitArray fail
+  istringstream iss("{ 1 ... 100 }");
+  BitArray<64> ba;
+  SpanReader<BitArray<64>, Indices>()(iss, ba);
+  cout << "BitArray overflow = " << iss.fail() << endl;
+
+  // Runs are decoded whole, rather than value by value
+  RangeSet<uint32_t> rs;
+  const auto tr = time_ms([&rs, &a] {
+    rs = read<RangeSet<uint32_t>>(a);
+  });
+  BitVector bits2;
+  const auto tv = time_ms([&bits2, &a] {
+    bits2 = read<BitVector>(a);
+  });
+  vector<uint32_t> values;
+  const auto tl = time_ms([&values, &a] {
+    values = read<vector<uint32_t>>(a);
+  });
+  cout << "decodings agree = " << (rs.size() == n && write(bits2) == a && values == in_order) << endl;
+  cout << "RangeSet:  " << tr << " ms for " << rs.num_ranges() << " ranges" << endl;
+  cout << "BitVector: " << tv << " ms" << endl;
+  cout << "vector:    " << tl << " ms" << endl;
+
+  const auto everything = read<RangeSet<uint32_t>>("{ 0 ... 100000000 }");
+  cout << "{ 0 ... 100000000 } holds " << everything.size() << " values in "
+       << everything.num_ranges() << " range" << endl;
+
+  // RangeSet agrees with std::set on random overlapping inserts
+  auto range_sets = true;
+  for (size_t i = 0; i < 20000 && range_sets; ++i) {
+    RangeSet<int> rs;
+    set<int> expected;
+    for (size_t j = 0, je = gen() % 20; j < je; ++j) {
+      const int lo = gen() % 300;
+      const int hi = lo + int(gen() % 12) - 2;
+      rs.insert(lo, hi);
+      for (auto k = lo; k <= hi; ++k) {
+        expected.insert(k);
+      }
+    }
+    range_sets = rs.size() == expected.size();
+    for (int k = -1; k < 320; ++k) {
+      range_sets &= rs.contains(k) == (expected.count(k) > 0);
+    }
+    // Ranges are sorted, disjoint and non-adjacent
+    for (auto r = rs.begin(); r != rs.end() && r + 1 != rs.end(); ++r) {
+      range_sets &= r->first <= r->second && r->second + 1 < (r + 1)->first;
+    }
+  }
+  cout << "RangeSet matches std::set = " << range_sets << endl;
+
+  // The extremes of a signed type neither overflow nor merge
+  RangeSet<int> extremes;
+  extremes.insert(INT_MIN, INT_MIN);
+  extremes.insert(INT_MAX, INT_MAX);
+  extremes.insert(INT_MIN + 2, INT_MIN + 2);
+  cout << "extremes = " << extremes.num_ranges() << " ranges, " << extremes.size()
+       << " values (should be 3 ranges, 3 values)" << endl;
+  RangeSet<int> full;
+  full.insert(0, INT_MAX);
+  full.insert(INT_MIN, -1);
+  cout << "full range = " << full.num_ranges() << " range, " << full.size() << " values (should be 1 range, "
+       << (size_t(1) << 32) << " values)" << endl;
+  RangeSet<int8_t> bytes;
+  bytes.insert(INT8_MIN, INT8_MAX);
+  cout << "int8_t range = " << bytes.size() << " values (should be 256)" << endl;
+
+  // Random spans, including open ranges, decode alike into every target
+  typedef Range<int, 0, 300> Small;
+  auto spans = true;
+  for (size_t i = 0; i < 20000 && spans; ++i) {
+    string span = "{ ";
+    auto etc = false;
+    for (int j = 0, je = gen() % 8, v = 0; j < je; ++j) {
+      if (!etc && gen() % 3 == 0) {
+        span += "... ";
+        etc = true;
+      } else if ((v += gen() % 40) <= Small::upper()) {
+        span += to_string(v) + " ";
+        etc = false;
+      }
+    }
+    span += "}";
+
+    bool ok = true;
+    const auto as_vector = read_as<vector<int>, Small>(span, ok);
+    const auto as_set = read_as<set<int>, Small>(span, ok);
+    const auto as_bits = read_as<BitVector, Small>(span, ok);
+    const auto as_ranges = read_as<RangeSet<int>, Small>(span, ok);
+
+    set<int> from_bits;
+    for (auto b = as_bits.set_bit_index_begin(), be = as_bits.set_bit_index_end(); b != be; ++b) {
+      from_bits.insert(*b);
+    }
+    set<int> from_ranges;
+    for (const auto& r : as_ranges) {
+      for (auto k = r.first; k <= r.second; ++k) {
+        from_ranges.insert(k);
+      }
+    }
+    spans = ok && set<int>(as_vector.begin(), as_vector.end()) == as_set &&
+            from_bits == as_set && from_ranges == as_set;
+    if (!spans) {
+      cout << "mismatch on " << span << endl;
+    }
+  }
+  cout << "random spans agree = " << spans << endl;
+
+  // Values that can't be bit indices fail rather than wrap
+  typedef Range<uint64_t, 0, ~0ull> Wide;
+  typedef Range<int, -10, 10> Signed;
+  bool ok = true;
+  read_as<BitVector, Wide>("{ 18446744073709551615 }", ok);
+  cout << "{ 18446744073709551615 } ok = " << ok << endl;
+  read_as<BitVector, Wide>("{ 5 ... }", ok);
+  cout << "{ 5 ... } ok = " << ok << endl;
+  read_as<BitVector, Signed>("{ -3 4 }", ok);
+  cout << "{ -3 4 } ok = " << ok << endl;
+  const auto negative = read_as<RangeSet<int>, Signed>("{ -3 ... 4 }", ok);
+  cout << "{ -3 ... 4 } as RangeSet ok = " << ok << ", size = " << negative.size() << endl;
+
+  return 0;
+}
@@ -0,0 +1,95 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "include/serialize/text_reader.h"
+#include "include/serialize/text_stream_reader.h"
+#include "include/serialize/text_writer.h"
+
+using namespace cpputil;
+using namespace std;
+
+/** Produces the literal { 0 1 2 ... n-1 } on demand, so that it is never
+    held in memory anywhere. */
+class CountingBuf : public streambuf {
+ public:
+  CountingBuf(size_t n) : i_(0), n_(n), state_(0) {
+    setg(buf_, buf_, buf_);
+  }
+
+ protected:
+  int_type underflow() override {
+    string s;
+    if (state_ == 0) {
+      s = "{ ";
+      state_ = 1;
+    } else if (i_ < n_) {
+      s = to_string(i_++) + " ";
+    } else if (state_ == 1) {
+      s = "}";
+      state_ = 2;
+    } else {
+      return traits_type::eof();
+    }
+    copy(s.begin(), s.end(), buf_);
+    setg(buf_, buf_, buf_ + s.size());
+    return traits_type::to_int_type(buf_[0]);
+  }
+
+ private:
+  char buf_[32];
+  size_t i_;
+  size_t n_;
+  int state_;
+};
+
+int main() {
+  // Ten million elements, one at a time
+  CountingBuf buf(10000000);
+  istream is(&buf);
+  uint64_t sum = 0;
+  size_t n = 0;
+  TextStreamReader<vector<uint64_t>>(is).for_each([&sum, &n](uint64_t i) {
+    sum += i;
+    ++n;
+  });
+  cout << "n = " << n << ", sum = " << sum << " (should be 10000000, 49999995000000)" << endl;
+  cout << "failed = " << is.fail() << " (should be 0)" << endl;
+
+  // Any Seq adaptor can be applied, and stops reading when it is done
+  map<string, int> m {{"a", 1}, {"b", 2}, {"c", 3}, {"d", 4}};
+  stringstream ss;
+  TextWriter<decltype(m)>()(ss, m);
+  TextStreamReader<decltype(m)> r(ss);
+  auto even = [](const pair<string, int>& p) {
+    return p.second % 2 == 0;
+  };
+  cout << "first even values: ";
+  for (const auto& p : r.filter(even).take(1)) {
+    cout << p.first << "=" << p.second << " ";
+  }
+  cout << "(should be b=2)" << endl;
+
+  // Malformed input sets failbit, just as TextReader would
+  stringstream bad("{ 1 2 x 4 }");
+  TextStreamReader<vector<int>> br(bad);
+  cout << "read " << br.count() << " before failing = " << bad.fail() << " (should be 2, 1)" << endl;
+
+  return 0;
+}
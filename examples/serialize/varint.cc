@@ -0,0 +1,60 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdint.h>
+
+#include "include/serialize/varint.h"
+
+using namespace cpputil;
+using namespace std;
+
+template <typename T>
+void check(T t) {
+  T t2 = T();
+
+  stringstream ss;
+  VarintWriter<T>()(ss, t);
+  const auto bytes = ss.str().size();
+  VarintReader<T>()(ss, t2);
+
+  cout << +t << " -> " << bytes << " bytes -> " << +t2 << (ss ? "" : " (failed)") << endl;
+}
+
+int main() {
+  check<uint8_t>(200);
+  check<int8_t>(-128);
+  check<uint32_t>(127);
+  check<uint32_t>(128);
+  check<int32_t>(-1);
+  check<int32_t>(-64);
+  check<int64_t>(numeric_limits<int64_t>::min());
+  check<uint64_t>(numeric_limits<uint64_t>::max());
+
+  // Truncated input and values which do not fit set failbit
+  stringstream truncated("\x80");
+  uint32_t u32 = 0;
+  VarintReader<uint32_t>()(truncated, u32);
+  cout << "truncated fails = " << truncated.fail() << " (should be 1)" << endl;
+
+  stringstream wide;
+  VarintWriter<uint32_t>()(wide, 300);
+  uint8_t u8 = 0;
+  VarintReader<uint8_t>()(wide, u8);
+  cout << "overflow fails = " << wide.fail() << " (should be 1)" << endl;
+
+  return 0;
+}
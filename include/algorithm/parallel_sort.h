@@ -0,0 +1,71 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_ALGORITHM_PARALLEL_SORT_H
+#define CPPUTIL_INCLUDE_ALGORITHM_PARALLEL_SORT_H
+
+#include <algorithm>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+namespace cpputil {
+
+/** Sorts [first, last) by splitting it into one chunk per thread, sorting the
+    chunks concurrently, and then merging adjacent chunks pairwise. Falls back
+    to std::sort for small inputs or when only one thread is available. */
+template <typename RandomIt, typename Compare>
+void parallel_sort(RandomIt first, RandomIt last, Compare comp, size_t threads = 0) {
+  const size_t n = std::distance(first, last);
+  if (threads == 0) {
+    threads = std::thread::hardware_concurrency();
+  }
+  if (threads < 2 || n < 4096 * threads) {
+    std::sort(first, last, comp);
+    return;
+  }
+
+  std::vector<RandomIt> bounds;
+  for (size_t i = 0; i < threads; ++i) {
+    bounds.push_back(first + n * i / threads);
+  }
+  bounds.push_back(last);
+
+  std::vector<std::thread> ts;
+  for (size_t i = 0; i < threads; ++i) {
+    ts.emplace_back([&bounds, &comp, i] {
+      std::sort(bounds[i], bounds[i + 1], comp);
+    });
+  }
+  for (auto& t : ts) {
+    t.join();
+  }
+
+  for (size_t width = 1; width < threads; width *= 2) {
+    ts.clear();
+    for (size_t i = 0; i + width < threads; i += 2 * width) {
+      const auto hi = std::min(i + 2 * width, threads);
+      ts.emplace_back([&bounds, &comp, i, width, hi] {
+        std::inplace_merge(bounds[i], bounds[i + width], bounds[hi], comp);
+      });
+    }
+    for (auto& t : ts) {
+      t.join();
+    }
+  }
+}
+
+} // namespace cpputil
+
+#endif
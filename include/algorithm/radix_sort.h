@@ -0,0 +1,91 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_ALGORITHM_RADIX_SORT_H
+#define CPPUTIL_INCLUDE_ALGORITHM_RADIX_SORT_H
+
+#include <algorithm>
+#include <iterator>
+#include <stddef.h>
+#include <type_traits>
+#include <vector>
+
+namespace cpputil {
+
+/** Moves each key in [first, last) to the next slot of its bucket in out.
+    offsets holds the next slot of each of the 256 buckets. */
+template <typename InIt, typename OutIt, typename CountIt, typename U>
+void radix_scatter(InIt first, InIt last, OutIt out, CountIt offsets, size_t shift, U flip) {
+  for (; first != last; ++first) {
+    out[offsets[((U(*first) ^ flip) >> shift) & 0xff]++] = *first;
+  }
+}
+
+/** Sorts the integers in [first, last) with a least significant digit radix
+    sort, one byte per pass. Every digit is histogrammed in a single read of
+    the input, and passes in which all keys share a digit are skipped, so
+    keys drawn from a small range (indices, say) cost only as many passes as
+    they have significant bytes. Signed keys are ordered by flipping their
+    sign bit. Falls back to std::sort for small inputs. Credit goes to:
+    Terdiman, Radix Sort Revisited */
+template <typename RandomIt>
+void radix_sort(RandomIt first, RandomIt last) {
+  typedef typename std::iterator_traits<RandomIt>::value_type T;
+  typedef typename std::make_unsigned<T>::type U;
+  static_assert(std::is_integral<T>::value, "radix_sort requires integer keys");
+
+  const size_t n = std::distance(first, last);
+  if (n < 256) {
+    std::sort(first, last);
+    return;
+  }
+
+  const U flip = std::is_signed<T>::value ? U(U(1) << (8 * sizeof(U) - 1)) : U(0);
+  std::vector<size_t> counts(256 * sizeof(U), 0);
+  for (auto i = first; i != last; ++i) {
+    const U u = U(*i) ^ flip;
+    for (size_t d = 0; d < sizeof(U); ++d) {
+      ++counts[256 * d + ((u >> (8 * d)) & 0xff)];
+    }
+  }
+
+  // Passes alternate between the input and a single scratch buffer
+  std::vector<T> buffer(n);
+  auto in_buffer = false;
+  for (size_t d = 0; d < sizeof(U); ++d) {
+    auto c = counts.begin() + 256 * d;
+    if (std::find(c, c + 256, n) != c + 256) {
+      continue;
+    }
+    size_t sum = 0;
+    for (size_t b = 0; b < 256; ++b) {
+      const auto count = c[b];
+      c[b] = sum;
+      sum += count;
+    }
+    if (in_buffer) {
+      radix_scatter(buffer.begin(), buffer.end(), first, c, 8 * d, flip);
+    } else {
+      radix_scatter(first, last, buffer.begin(), c, 8 * d, flip);
+    }
+    in_buffer = !in_buffer;
+  }
+  if (in_buffer) {
+    std::copy(buffer.begin(), buffer.end(), first);
+  }
+}
+
+} // namespace cpputil
+
+#endif
@@ -15,8 +15,20 @@
 #ifndef CPPUTIL_INCLUDE_CONTAINER_BIJECTION_H
 #define CPPUTIL_INCLUDE_CONTAINER_BIJECTION_H
 
+#include <algorithm>
+#include <functional>
 #include <initializer_list>
+#include <iterator>
 #include <map>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "include/algorithm/parallel_sort.h"
+#include "include/container/hash_stats.h"
+#include "include/memory/memory_usage.h"
+#include "include/meta/has_reserve.h"
 
 namespace cpputil {
 
@@ -33,6 +45,17 @@ class Bijection {
   typedef const value_type& const_reference;
   typedef typename DMap::size_type size_type;
 
+  Bijection() { }
+
+  template <typename InputIterator>
+  Bijection(InputIterator first, InputIterator last) {
+    insert(first, last);
+  }
+
+  Bijection(std::initializer_list<value_type> il) {
+    insert(il);
+  }
+
   const_iterator begin() const {
     return d2r_.begin();
   }
@@ -62,28 +85,117 @@ class Bijection {
     r2d_.clear();
   }
 
+  /** Total bytes used by both maps, including node, bucket and element heap
+      overhead. See MemoryUsage for how each map type is accounted. */
+  size_t memory_usage() const {
+    return sizeof(*this) + MemoryUsage<DMap>()(d2r_) + MemoryUsage<RMap>()(r2d_);
+  }
+
+  /** Hash statistics for the domain to range map; requires a hashed DMap. */
+  HashStats domain_hash_stats() const {
+    return HashProfiler<DMap>()(d2r_);
+  }
+
+  /** Hash statistics for the range to domain map; requires a hashed RMap. */
+  HashStats range_hash_stats() const {
+    return HashProfiler<RMap>()(r2d_);
+  }
+
+  /** Presizes both underlying maps for n elements; a no-op for maps without reserve(). */
+  void reserve(size_type n) {
+    reserve_map(d2r_, n);
+    reserve_map(r2d_, n);
+  }
+
   std::pair<const_iterator, bool> insert(const value_type& val) {
-    if (d2r_.find(val.first) != d2r_.end() || r2d_.find(val.second) != r2d_.end()) {
+    const auto d = d2r_.insert(val);
+    if (!d.second) {
+      return std::make_pair(end(), false);
+    }
+    if (!r2d_.insert(std::make_pair(val.second, val.first)).second) {
+      d2r_.erase(d.first);
       return std::make_pair(end(), false);
-    } else {
-      r2d_.insert(std::make_pair(val.second, val.first));
-      return d2r_.insert(val);
     }
+    return std::make_pair(const_iterator(d.first), true);
   }
 
   template <typename InputIterator>
   void insert(InputIterator first, InputIterator last) {
+    presize(first, last, typename std::iterator_traits<InputIterator>::iterator_category());
     for (; first != last; ++first) {
       insert(*first);
     }
   }
 
   void insert(std::initializer_list<value_type> il) {
+    reserve(size() + il.size());
     for (const auto& i : il) {
-      insert(*i);
+      insert(i);
     }
   }
 
+  /** Replaces the contents of this bijection with the pairs in [first, last).
+      Rather than inserting one pair at a time, the input is sorted once by
+      domain and once by range, duplicate pairs are dropped, and conflicts
+      (a domain or range value paired with two different values) are detected
+      by comparing neighbors. The maps are then built from sorted input. If
+      parallel is set, sorting uses all cores and the two maps are built
+      concurrently. Returns false and leaves this bijection unchanged if the
+      input contains a conflict. Requires D and R to be less-than comparable. */
+  template <typename InputIterator>
+  bool assign(InputIterator first, InputIterator last, bool parallel = false) {
+    typedef std::pair<D, R> pair_type;
+    const size_t threads = parallel ? 0 : 1;
+
+    std::vector<pair_type> vals(first, last);
+    parallel_sort(vals.begin(), vals.end(), std::less<pair_type>(), threads);
+    vals.erase(std::unique(vals.begin(), vals.end()), vals.end());
+
+    std::vector<const pair_type*> by_range;
+    by_range.reserve(vals.size());
+    for (size_t i = 0, ie = vals.size(); i < ie; ++i) {
+      if (i > 0 && !(vals[i - 1].first < vals[i].first)) {
+        return false;
+      }
+      by_range.push_back(&vals[i]);
+    }
+    parallel_sort(by_range.begin(), by_range.end(), [](const pair_type* a, const pair_type* b) {
+      return a->second < b->second;
+    }, threads);
+    for (size_t i = 1, ie = by_range.size(); i < ie; ++i) {
+      if (!(by_range[i - 1]->second < by_range[i]->second)) {
+        return false;
+      }
+    }
+
+    DMap d2r;
+    RMap r2d;
+    const auto build_d2r = [&d2r, &vals] {
+      reserve_map(d2r, vals.size());
+      for (const auto& v : vals) {
+        d2r.emplace_hint(d2r.end(), v.first, v.second);
+      }
+    };
+    const auto build_r2d = [&r2d, &by_range] {
+      reserve_map(r2d, by_range.size());
+      for (const auto v : by_range) {
+        r2d.emplace_hint(r2d.end(), v->second, v->first);
+      }
+    };
+    if (parallel) {
+      std::thread t(build_r2d);
+      build_d2r();
+      t.join();
+    } else {
+      build_d2r();
+      build_r2d();
+    }
+
+    d2r_.swap(d2r);
+    r2d_.swap(r2d);
+    return true;
+  }
+
   const_iterator erase(const_iterator position) {
     r2d_.erase(position->second);
     return d2r_.erase(position);
@@ -143,6 +255,27 @@ class Bijection {
  private:
   DMap d2r_;
   RMap r2d_;
+
+  template <typename Map>
+  static void reserve_map(Map& m, size_type n) {
+    reserve_map(m, n, std::integral_constant<bool, has_reserve<Map>::value>());
+  }
+
+  template <typename Map>
+  static void reserve_map(Map& m, size_type n, std::true_type) {
+    m.reserve(n);
+  }
+
+  template <typename Map>
+  static void reserve_map(Map&, size_type, std::false_type) { }
+
+  template <typename InputIterator>
+  void presize(InputIterator first, InputIterator last, std::forward_iterator_tag) {
+    reserve(size() + std::distance(first, last));
+  }
+
+  template <typename InputIterator>
+  void presize(InputIterator, InputIterator, std::input_iterator_tag) { }
 };
 
 } // namespace cpputil
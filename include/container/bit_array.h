@@ -31,6 +31,11 @@ class BitArray : public BitString < std::array < uint64_t, (N + 63) / 64 >> {
     this->num_bits_ = N;
   }
 
+  /** Returns the number of bits a BitArray holds. */
+  static constexpr size_t max_bits() {
+    return N;
+  }
+
   /** Set all elements to zero. */
   void unset() {
     this->contents_.fill(0);
@@ -357,6 +357,27 @@ class BitString {
     return ((double*) contents_.data())[i];
   }
 
+  /** Sets bits lo through hi - 1. Interior words are filled whole. */
+  void set_range(size_t lo, size_t hi) {
+    assert(lo <= hi && hi <= num_bits());
+    if (lo == hi) {
+      return;
+    }
+    const auto first = lo / 64;
+    const auto last = (hi - 1) / 64;
+    const auto lo_mask = ~0ull << (lo % 64);
+    const auto hi_mask = ~0ull >> (63 - (hi - 1) % 64);
+    if (first == last) {
+      contents_[first] |= lo_mask & hi_mask;
+      return;
+    }
+    contents_[first] |= lo_mask;
+    for (auto i = first + 1; i < last; ++i) {
+      contents_[i] = ~0ull;
+    }
+    contents_[last] |= hi_mask;
+  }
+
   /** Set bit index iterator. */
   const_set_bit_index_iterator set_bit_index_begin() const {
     return const_set_bit_index_iterator(contents_.begin(), contents_.begin(), contents_.end(),
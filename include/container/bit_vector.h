@@ -34,6 +34,12 @@ class BitVector : public BitString<std::vector<uint64_t, Aligned<uint64_t, 32>>>
     num_bits_ = n;
   }
 
+  /** Returns the largest number of bits a BitVector can hold. */
+  size_t max_bits() const {
+    const auto words = contents_.max_size();
+    return words > SIZE_MAX / 64 ? SIZE_MAX - 63 : 64 * words;
+  }
+
   /** Resizes a BitVector to contain n bits. */
   void resize_for_bits(size_t n) {
     contents_.resize((n + 63) / 64);
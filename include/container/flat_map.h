@@ -0,0 +1,448 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_CONTAINER_FLAT_MAP_H
+#define CPPUTIL_INCLUDE_CONTAINER_FLAT_MAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "include/memory/memory_usage.h"
+
+namespace cpputil {
+
+/** A map stored as two sorted, contiguous arrays: one of keys and one of
+    values. Lookups use a branchless binary search over the keys. Calling
+    freeze() additionally builds an Eytzinger (breadth-first) copy of the keys
+    which makes lookups cache-friendly and prefetchable for read-mostly maps.
+    Any operation that adds or removes a key discards the frozen layout. The
+    interface mirrors std::map closely enough to be wrapped by CppUtilMap. */
+template <typename Key, typename T, typename Compare = std::less<Key>>
+class FlatMap {
+ private:
+  /** Dereferencing an iterator produces a pair of references into the
+      key and value arrays; operator-> needs somewhere to put it. */
+  template <typename Reference>
+  class arrow_proxy {
+   public:
+    arrow_proxy(const Reference& r) : r_(r) { }
+    const Reference* operator->() const {
+      return &r_;
+    }
+   private:
+    Reference r_;
+  };
+
+  template <typename Map, typename Mapped>
+  class basic_iterator {
+    friend class FlatMap;
+
+   public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef std::pair<const Key&, Mapped&> value_type;
+    typedef std::pair<const Key&, Mapped&> reference;
+    typedef arrow_proxy<reference> pointer;
+    typedef ptrdiff_t difference_type;
+
+    basic_iterator() : map_(nullptr), i_(0) { }
+    /** Conversion from iterator to const_iterator. */
+    template <typename M2, typename V2>
+    basic_iterator(const basic_iterator<M2, V2>& rhs) : map_(rhs.map_), i_(rhs.i_) { }
+
+    reference operator*() const {
+      return reference(map_->keys_[i_], map_->values_[i_]);
+    }
+    pointer operator->() const {
+      return pointer(**this);
+    }
+    reference operator[](difference_type n) const {
+      return *(*this + n);
+    }
+
+    basic_iterator& operator++() {
+      ++i_;
+      return *this;
+    }
+    basic_iterator operator++(int) {
+      auto ret = *this;
+      ++i_;
+      return ret;
+    }
+    basic_iterator& operator--() {
+      --i_;
+      return *this;
+    }
+    basic_iterator operator--(int) {
+      auto ret = *this;
+      --i_;
+      return ret;
+    }
+    basic_iterator& operator+=(difference_type n) {
+      i_ += n;
+      return *this;
+    }
+    basic_iterator& operator-=(difference_type n) {
+      i_ -= n;
+      return *this;
+    }
+    basic_iterator operator+(difference_type n) const {
+      return basic_iterator(map_, i_ + n);
+    }
+    basic_iterator operator-(difference_type n) const {
+      return basic_iterator(map_, i_ - n);
+    }
+    difference_type operator-(const basic_iterator& rhs) const {
+      return difference_type(i_) - difference_type(rhs.i_);
+    }
+
+    bool operator==(const basic_iterator& rhs) const {
+      return i_ == rhs.i_;
+    }
+    bool operator!=(const basic_iterator& rhs) const {
+      return i_ != rhs.i_;
+    }
+    bool operator<(const basic_iterator& rhs) const {
+      return i_ < rhs.i_;
+    }
+    bool operator>(const basic_iterator& rhs) const {
+      return i_ > rhs.i_;
+    }
+    bool operator<=(const basic_iterator& rhs) const {
+      return i_ <= rhs.i_;
+    }
+    bool operator>=(const basic_iterator& rhs) const {
+      return i_ >= rhs.i_;
+    }
+
+   private:
+    template <typename M2, typename V2>
+    friend class basic_iterator;
+
+    basic_iterator(Map* map, size_t i) : map_(map), i_(i) { }
+
+    Map* map_;
+    size_t i_;
+  };
+
+ public:
+  typedef Key key_type;
+  typedef T mapped_type;
+  typedef std::pair<Key, T> value_type;
+  typedef Compare key_compare;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef basic_iterator<FlatMap, T> iterator;
+  typedef basic_iterator<const FlatMap, const T> const_iterator;
+
+  FlatMap() { }
+
+  /** Builds a map from a range of pairs with a single sort. As with std::map,
+      the first occurrence of a duplicate key wins. */
+  template <typename InputIterator>
+  FlatMap(InputIterator first, InputIterator last) {
+    assign(first, last);
+  }
+
+  FlatMap(std::initializer_list<value_type> il) {
+    assign(il.begin(), il.end());
+  }
+
+  template <typename InputIterator>
+  void assign(InputIterator first, InputIterator last) {
+    std::vector<value_type> vals(first, last);
+    std::stable_sort(vals.begin(), vals.end(), [this](const value_type& a, const value_type& b) {
+      return comp_(a.first, b.first);
+    });
+
+    clear();
+    keys_.reserve(vals.size());
+    values_.reserve(vals.size());
+    for (auto& v : vals) {
+      if (keys_.empty() || comp_(keys_.back(), v.first)) {
+        keys_.push_back(std::move(v.first));
+        values_.push_back(std::move(v.second));
+      }
+    }
+  }
+
+  /** Builds the Eytzinger layout used to accelerate lookups. The layout
+      holds a second copy of every key, so it doubles key memory and
+      requires Key to be copy constructible. keys_ itself stays sorted, since
+      iteration and the unfrozen search depend on it. */
+  void freeze() {
+    static_assert(std::is_copy_constructible<Key>::value,
+                  "FlatMap::freeze() requires copy constructible keys");
+    eyt_index_.resize(keys_.size() + 1);
+    size_t i = 0;
+    build_eytzinger(i, 1);
+    // Slot 0 is a sentinel: a failed search decodes to index 0.
+    eyt_index_[0] = keys_.size();
+
+    // Copy rather than resize, so that Key needn't be default constructible.
+    // The sentinel key is never compared against.
+    eyt_keys_.clear();
+    eyt_keys_.reserve(keys_.size() + 1);
+    for (size_t k = 0, ke = keys_.empty() ? 0 : eyt_index_.size(); k < ke; ++k) {
+      eyt_keys_.push_back(keys_[k == 0 ? 0 : eyt_index_[k]]);
+    }
+  }
+
+  /** Returns true if the Eytzinger layout is current. */
+  bool frozen() const {
+    return !eyt_index_.empty();
+  }
+
+  iterator begin() {
+    return iterator(this, 0);
+  }
+  const_iterator begin() const {
+    return const_iterator(this, 0);
+  }
+  const_iterator cbegin() const {
+    return begin();
+  }
+  iterator end() {
+    return iterator(this, size());
+  }
+  const_iterator end() const {
+    return const_iterator(this, size());
+  }
+  const_iterator cend() const {
+    return end();
+  }
+
+  /** Contiguous key storage, in sorted order. */
+  const key_type* key_data() const {
+    return keys_.data();
+  }
+  /** Contiguous value storage, in key order. */
+  mapped_type* value_data() {
+    return values_.data();
+  }
+  /** Contiguous value storage, in key order. */
+  const mapped_type* value_data() const {
+    return values_.data();
+  }
+
+  /** Total bytes used by this map, including any frozen layout and heap
+      memory owned by the keys and values. */
+  size_t memory_usage() const {
+    return sizeof(*this) + MemoryUsage<std::vector<Key>>()(keys_) +
+           MemoryUsage<std::vector<T>>()(values_) + MemoryUsage<std::vector<Key>>()(eyt_keys_) +
+           MemoryUsage<std::vector<size_t>>()(eyt_index_);
+  }
+
+  bool empty() const {
+    return keys_.empty();
+  }
+  size_type size() const {
+    return keys_.size();
+  }
+  void reserve(size_type n) {
+    keys_.reserve(n);
+    values_.reserve(n);
+  }
+  void clear() {
+    keys_.clear();
+    values_.clear();
+    thaw();
+  }
+
+  iterator find(const key_type& k) {
+    return iterator(this, find_index(k));
+  }
+  const_iterator find(const key_type& k) const {
+    return const_iterator(this, find_index(k));
+  }
+  size_type count(const key_type& k) const {
+    return find_index(k) == size() ? 0 : 1;
+  }
+  iterator lower_bound(const key_type& k) {
+    return iterator(this, lower_bound_index(k));
+  }
+  const_iterator lower_bound(const key_type& k) const {
+    return const_iterator(this, lower_bound_index(k));
+  }
+
+  mapped_type& at(const key_type& k) {
+    const auto i = find_index(k);
+    if (i == size()) {
+      throw std::out_of_range("FlatMap::at");
+    }
+    return values_[i];
+  }
+  const mapped_type& at(const key_type& k) const {
+    const auto i = find_index(k);
+    if (i == size()) {
+      throw std::out_of_range("FlatMap::at");
+    }
+    return values_[i];
+  }
+  mapped_type& operator[](const key_type& k) {
+    return emplace(k, mapped_type()).first->second;
+  }
+
+  std::pair<iterator, bool> insert(const value_type& val) {
+    return emplace(val.first, val.second);
+  }
+  /** Inserts a range of pairs with a single sort and a linear merge. Keys
+      already in the map win, and otherwise the first occurrence of a
+      duplicate key wins. */
+  template <typename InputIterator>
+  void insert(InputIterator first, InputIterator last) {
+    FlatMap rhs(first, last);
+    if (rhs.empty()) {
+      return;
+    }
+
+    std::vector<Key> keys;
+    std::vector<T> values;
+    keys.reserve(size() + rhs.size());
+    values.reserve(size() + rhs.size());
+    for (size_t i = 0, j = 0; i < size() || j < rhs.size();) {
+      if (j == rhs.size() || (i < size() && !comp_(rhs.keys_[j], keys_[i]))) {
+        if (j < rhs.size() && !comp_(keys_[i], rhs.keys_[j])) {
+          ++j;
+        }
+        keys.push_back(std::move(keys_[i]));
+        values.push_back(std::move(values_[i++]));
+      } else {
+        keys.push_back(std::move(rhs.keys_[j]));
+        values.push_back(std::move(rhs.values_[j++]));
+      }
+    }
+    keys_.swap(keys);
+    values_.swap(values);
+    thaw();
+  }
+  template <typename K, typename V>
+  std::pair<iterator, bool> emplace(K&& k, V&& v) {
+    const auto i = lower_bound_index(k);
+    if (i < size() && !comp_(k, keys_[i])) {
+      return std::make_pair(iterator(this, i), false);
+    }
+    keys_.emplace(keys_.begin() + i, std::forward<K>(k));
+    values_.emplace(values_.begin() + i, std::forward<V>(v));
+    thaw();
+    return std::make_pair(iterator(this, i), true);
+  }
+
+  iterator erase(const_iterator pos) {
+    keys_.erase(keys_.begin() + pos.i_);
+    values_.erase(values_.begin() + pos.i_);
+    thaw();
+    return iterator(this, pos.i_);
+  }
+  size_type erase(const key_type& k) {
+    const auto i = find_index(k);
+    if (i == size()) {
+      return 0;
+    }
+    erase(const_iterator(this, i));
+    return 1;
+  }
+
+  void swap(FlatMap& rhs) {
+    keys_.swap(rhs.keys_);
+    values_.swap(rhs.values_);
+    eyt_keys_.swap(rhs.eyt_keys_);
+    eyt_index_.swap(rhs.eyt_index_);
+    std::swap(comp_, rhs.comp_);
+  }
+
+  bool operator==(const FlatMap& rhs) const {
+    return keys_ == rhs.keys_ && values_ == rhs.values_;
+  }
+  bool operator!=(const FlatMap& rhs) const {
+    return !(*this == rhs);
+  }
+
+ private:
+  std::vector<Key> keys_;
+  std::vector<T> values_;
+  /** Keys in Eytzinger order (1-indexed) and their positions in keys_. */
+  std::vector<Key> eyt_keys_;
+  std::vector<size_t> eyt_index_;
+  Compare comp_;
+
+  void thaw() {
+    eyt_keys_.clear();
+    eyt_index_.clear();
+  }
+
+  void build_eytzinger(size_t& i, size_t k) {
+    if (k <= keys_.size()) {
+      build_eytzinger(i, 2 * k);
+      eyt_index_[k] = i++;
+      build_eytzinger(i, 2 * k + 1);
+    }
+  }
+
+  size_t lower_bound_index(const key_type& k) const {
+    if (frozen()) {
+      const auto n = keys_.size();
+      const auto data = eyt_keys_.data();
+      size_t i = 1;
+      while (i <= n) {
+        // The address may lie past the end of the array, which is harmless
+        // for a prefetch but undefined as pointer arithmetic
+        __builtin_prefetch((const void*)((uintptr_t)data + 16 * i * sizeof(Key)));
+        i = 2 * i + comp_(data[i], k);
+      }
+      // Strip the trailing right turns and the final left turn.
+      i >>= __builtin_ffsll(~i);
+      return eyt_index_[i];
+    }
+
+    const auto data = keys_.data();
+    auto base = data;
+    auto n = keys_.size();
+    if (n == 0) {
+      return 0;
+    }
+    while (n > 1) {
+      const auto half = n / 2;
+      base = comp_(base[half], k) ? base + half : base;
+      n -= half;
+    }
+    return (base - data) + comp_(*base, k);
+  }
+
+  size_t find_index(const key_type& k) const {
+    const auto i = lower_bound_index(k);
+    return (i < size() && !comp_(k, keys_[i])) ? i : size();
+  }
+};
+
+} // namespace cpputil
+
+namespace std {
+
+/** STL-compliant swap. */
+template <typename Key, typename T, typename Compare>
+void swap(cpputil::FlatMap<Key, T, Compare>& lhs, cpputil::FlatMap<Key, T, Compare>& rhs) {
+  lhs.swap(rhs);
+}
+
+} // namespace std
+
+#endif
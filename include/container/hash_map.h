@@ -0,0 +1,129 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_CONTAINER_HASH_MAP_H
+#define CPPUTIL_INCLUDE_CONTAINER_HASH_MAP_H
+
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "include/container/hash_table.h"
+
+namespace cpputil {
+
+/** Stores (key, value) pairs inline in the slot array. */
+template <typename Key, typename T>
+struct HashMapPolicy {
+  typedef Key key_type;
+  typedef std::pair<const Key, T> value_type;
+  typedef std::pair<Key, T> init_type;
+
+  /** Elements are exposed as value_type, but rehashing needs to move keys,
+      which const forbids. The slot is a union of both pair types: elements
+      live in value, and transfer() moves out of mutable_value. Credit goes
+      to: abseil's map_slot_type. */
+  union slot_type {
+    slot_type() { }
+    ~slot_type() { }
+
+    value_type value;
+    init_type mutable_value;
+  };
+
+  static constexpr bool constant_elements() {
+    return false;
+  }
+  static constexpr size_t node_size() {
+    return 0;
+  }
+  static const key_type& key(const slot_type& s) {
+    return s.value.first;
+  }
+  static const key_type& init_key(const init_type& v) {
+    return v.first;
+  }
+  static value_type& element(slot_type& s) {
+    return s.value;
+  }
+  static void construct(slot_type* s, init_type&& v) {
+    new (&s->value) value_type(std::move(v));
+  }
+  static void transfer(slot_type* dst, slot_type* src) {
+    new (&dst->mutable_value) init_type(std::move(src->mutable_value));
+    src->value.~value_type();
+  }
+  static void destroy(slot_type* s) {
+    s->value.~value_type();
+  }
+};
+
+/** A drop-in replacement for std::unordered_map backed by a HashTable.
+    Unlike std::unordered_map, rehashing moves elements, so references and
+    iterators are invalidated by any insertion that grows the table. */
+template <typename Key, typename T, typename Hash = std::hash<Key>,
+          typename Eq = std::equal_to<Key>>
+class HashMap : public HashTable<HashMapPolicy<Key, T>, Hash, Eq> {
+  typedef HashTable<HashMapPolicy<Key, T>, Hash, Eq> base_type;
+
+ public:
+  typedef T mapped_type;
+
+  HashMap() : base_type() { }
+
+  template <typename InputIterator>
+  HashMap(InputIterator first, InputIterator last) : base_type(first, last) { }
+
+  HashMap(std::initializer_list<typename base_type::init_type> il) : base_type(il) { }
+
+  T& at(const Key& k) {
+    const auto itr = this->find(k);
+    if (itr == this->end()) {
+      throw std::out_of_range("HashMap::at");
+    }
+    return itr->second;
+  }
+
+  const T& at(const Key& k) const {
+    const auto itr = this->find(k);
+    if (itr == this->end()) {
+      throw std::out_of_range("HashMap::at");
+    }
+    return itr->second;
+  }
+
+  T& operator[](const Key& k) {
+    const auto h = this->hash(k);
+    auto i = this->find_index(k, h);
+    if (i == this->bucket_count()) {
+      i = this->insert_new(h, std::make_pair(k, T()));
+    }
+    return this->slots()[i].value.second;
+  }
+};
+
+} // namespace cpputil
+
+namespace std {
+
+/** STL-compliant swap. */
+template <typename Key, typename T, typename Hash, typename Eq>
+void swap(cpputil::HashMap<Key, T, Hash, Eq>& lhs, cpputil::HashMap<Key, T, Hash, Eq>& rhs) {
+  lhs.swap(rhs);
+}
+
+} // namespace std
+
+#endif
@@ -0,0 +1,144 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_CONTAINER_HASH_SET_H
+#define CPPUTIL_INCLUDE_CONTAINER_HASH_SET_H
+
+#include <functional>
+#include <new>
+#include <utility>
+
+#include "include/container/hash_table.h"
+
+namespace cpputil {
+
+/** Stores keys inline in the slot array. */
+template <typename Key>
+struct HashSetPolicy {
+  typedef Key key_type;
+  typedef Key value_type;
+  typedef Key init_type;
+  typedef Key slot_type;
+
+  static constexpr bool constant_elements() {
+    return true;
+  }
+  static constexpr size_t node_size() {
+    return 0;
+  }
+  static const key_type& key(const slot_type& s) {
+    return s;
+  }
+  static const key_type& init_key(const init_type& v) {
+    return v;
+  }
+  static value_type& element(slot_type& s) {
+    return s;
+  }
+  static void construct(slot_type* s, init_type&& v) {
+    new (s) slot_type(std::move(v));
+  }
+  static void transfer(slot_type* dst, slot_type* src) {
+    new (dst) slot_type(std::move(*src));
+    src->~slot_type();
+  }
+  static void destroy(slot_type* s) {
+    s->~slot_type();
+  }
+};
+
+/** Stores pointers to individually allocated keys in the slot array. */
+template <typename Key>
+struct NodeHashSetPolicy {
+  typedef Key key_type;
+  typedef Key value_type;
+  typedef Key init_type;
+  typedef Key* slot_type;
+
+  static constexpr bool constant_elements() {
+    return true;
+  }
+  static constexpr size_t node_size() {
+    return sizeof(Key);
+  }
+  static const key_type& key(const slot_type& s) {
+    return *s;
+  }
+  static const key_type& init_key(const init_type& v) {
+    return v;
+  }
+  static value_type& element(slot_type& s) {
+    return *s;
+  }
+  static void construct(slot_type* s, init_type&& v) {
+    *s = new Key(std::move(v));
+  }
+  static void transfer(slot_type* dst, slot_type* src) {
+    *dst = *src;
+  }
+  static void destroy(slot_type* s) {
+    delete *s;
+  }
+};
+
+/** A drop-in replacement for std::unordered_set backed by a HashTable.
+    References to elements are invalidated when the table grows. */
+template <typename Key, typename Hash = std::hash<Key>, typename Eq = std::equal_to<Key>>
+class HashSet : public HashTable<HashSetPolicy<Key>, Hash, Eq> {
+  typedef HashTable<HashSetPolicy<Key>, Hash, Eq> base_type;
+
+ public:
+  HashSet() : base_type() { }
+
+  template <typename InputIterator>
+  HashSet(InputIterator first, InputIterator last) : base_type(first, last) { }
+
+  HashSet(std::initializer_list<Key> il) : base_type(il) { }
+};
+
+/** A HashSet whose elements never move once inserted, at the cost of one
+    allocation and one extra indirection per element. This is the variant to
+    use with Interner, which hands out references to its contents. */
+template <typename Key, typename Hash = std::hash<Key>, typename Eq = std::equal_to<Key>>
+class NodeHashSet : public HashTable<NodeHashSetPolicy<Key>, Hash, Eq> {
+  typedef HashTable<NodeHashSetPolicy<Key>, Hash, Eq> base_type;
+
+ public:
+  NodeHashSet() : base_type() { }
+
+  template <typename InputIterator>
+  NodeHashSet(InputIterator first, InputIterator last) : base_type(first, last) { }
+
+  NodeHashSet(std::initializer_list<Key> il) : base_type(il) { }
+};
+
+} // namespace cpputil
+
+namespace std {
+
+/** STL-compliant swap. */
+template <typename Key, typename Hash, typename Eq>
+void swap(cpputil::HashSet<Key, Hash, Eq>& lhs, cpputil::HashSet<Key, Hash, Eq>& rhs) {
+  lhs.swap(rhs);
+}
+
+/** STL-compliant swap. */
+template <typename Key, typename Hash, typename Eq>
+void swap(cpputil::NodeHashSet<Key, Hash, Eq>& lhs, cpputil::NodeHashSet<Key, Hash, Eq>& rhs) {
+  lhs.swap(rhs);
+}
+
+} // namespace std
+
+#endif
@@ -0,0 +1,105 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_CONTAINER_HASH_STATS_H
+#define CPPUTIL_INCLUDE_CONTAINER_HASH_STATS_H
+
+#include <algorithm>
+#include <stddef.h>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace cpputil {
+
+/** A snapshot of the health of a hash table. A probe is one bucket visit for
+    a chained table, or one group load for an open addressing table; the
+    probe lengths are those of successful lookups for the current contents. */
+struct HashStats {
+  HashStats() :
+    size(0), capacity(0), load_factor(0), tombstones(0), rehashes(0),
+    mean_probe_length(0), max_probe_length(0) { }
+
+  size_t size;
+  /** Number of buckets (chained) or slots (open addressing). */
+  size_t capacity;
+  float load_factor;
+  /** Erased slots not yet reclaimed; always zero for chained tables. */
+  size_t tombstones;
+  /** Number of times the table has grown; only tracked by HashTable. */
+  size_t rehashes;
+  double mean_probe_length;
+  size_t max_probe_length;
+};
+
+/** Computes HashStats for a hash table. This walks the whole table and is
+    meant for periodic monitoring, not for hot paths. */
+template <typename T, typename Enable = void>
+struct HashProfiler;
+
+template <typename T>
+struct has_hash_stats {
+ private:
+  template <typename U>
+  static auto test(int) -> decltype(std::declval<const U&>().hash_stats(), std::true_type());
+  template <typename U>
+  static std::false_type test(...);
+
+ public:
+  static constexpr bool value = decltype(test<T>(0))::value;
+};
+
+template <typename T>
+struct HashProfiler<T, typename std::enable_if<has_hash_stats<T>::value>::type> {
+  HashStats operator()(const T& t) const {
+    return t.hash_stats();
+  }
+};
+
+/** The element in position i of a chain takes i probes to find. */
+template <typename C>
+HashStats chained_hash_stats(const C& c) {
+  HashStats stats;
+  stats.size = c.size();
+  stats.capacity = c.bucket_count();
+  stats.load_factor = c.load_factor();
+
+  size_t total = 0;
+  for (size_t b = 0, be = c.bucket_count(); b < be; ++b) {
+    const auto n = c.bucket_size(b);
+    total += n * (n + 1) / 2;
+    stats.max_probe_length = std::max(stats.max_probe_length, n);
+  }
+  stats.mean_probe_length = c.empty() ? 0 : double(total) / c.size();
+  return stats;
+}
+
+template <typename K, typename T, typename H, typename E, typename A>
+struct HashProfiler<std::unordered_map<K, T, H, E, A>> {
+  HashStats operator()(const std::unordered_map<K, T, H, E, A>& m) const {
+    return chained_hash_stats(m);
+  }
+};
+
+template <typename K, typename H, typename E, typename A>
+struct HashProfiler<std::unordered_set<K, H, E, A>> {
+  HashStats operator()(const std::unordered_set<K, H, E, A>& s) const {
+    return chained_hash_stats(s);
+  }
+};
+
+} // namespace cpputil
+
+#endif
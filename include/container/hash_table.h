@@ -0,0 +1,594 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_CONTAINER_HASH_TABLE_H
+#define CPPUTIL_INCLUDE_CONTAINER_HASH_TABLE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <immintrin.h>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+
+#include "include/bits/bit_manip.h"
+#include "include/container/hash_stats.h"
+#include "include/memory/memory_usage.h"
+
+namespace cpputil {
+
+/** An open-addressing hash table in the style of Google's Swiss tables. Each
+    slot has a one-byte control word which is either empty, deleted, or holds
+    seven bits of the element's hash. Lookups load a whole group of control
+    words at once and compare them in parallel using AVX2 (32 slots), SSE2
+    (16 slots), or a portable fallback (8 slots), so most probes touch a single
+    cache line and compare at most one key. The storage details (flat or
+    node-based, set or map) are supplied by a Policy; see HashMap and HashSet.
+
+    Credit goes to: https://abseil.io/about/design/swisstables */
+template <typename Policy, typename Hash, typename Eq>
+class HashTable {
+ public:
+  typedef typename Policy::key_type key_type;
+  typedef typename Policy::value_type value_type;
+  typedef typename Policy::init_type init_type;
+  typedef Hash hasher;
+  typedef Eq key_equal;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+ private:
+  typedef typename Policy::slot_type slot_type;
+  typedef int8_t ctrl_type;
+
+  static constexpr ctrl_type empty_ctrl() {
+    return -128;
+  }
+  static constexpr ctrl_type deleted_ctrl() {
+    return -2;
+  }
+
+#if defined(__AVX2__) && defined(__AVX__)
+  static constexpr size_t group_width() {
+    return 32;
+  }
+  class Group {
+   public:
+    explicit Group(const ctrl_type* pos) : ctrl_(_mm256_loadu_si256((const __m256i*) pos)) { }
+    uint32_t match(ctrl_type h2) const {
+      return _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_set1_epi8(h2), ctrl_));
+    }
+    uint32_t match_empty() const {
+      return match(empty_ctrl());
+    }
+    uint32_t match_empty_or_deleted() const {
+      return _mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_set1_epi8(-1), ctrl_));
+    }
+   private:
+    __m256i ctrl_;
+  };
+#elif defined(__SSE2__)
+  static constexpr size_t group_width() {
+    return 16;
+  }
+  class Group {
+   public:
+    explicit Group(const ctrl_type* pos) : ctrl_(_mm_loadu_si128((const __m128i*) pos)) { }
+    uint32_t match(ctrl_type h2) const {
+      return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_));
+    }
+    uint32_t match_empty() const {
+      return match(empty_ctrl());
+    }
+    uint32_t match_empty_or_deleted() const {
+      return _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl_));
+    }
+   private:
+    __m128i ctrl_;
+  };
+#else
+  static constexpr size_t group_width() {
+    return 8;
+  }
+  class Group {
+   public:
+    explicit Group(const ctrl_type* pos) {
+      std::memcpy(ctrl_, pos, 8);
+    }
+    uint32_t match(ctrl_type h2) const {
+      uint32_t res = 0;
+      for (size_t i = 0; i < 8; ++i) {
+        res |= (ctrl_[i] == h2) << i;
+      }
+      return res;
+    }
+    uint32_t match_empty() const {
+      return match(empty_ctrl());
+    }
+    uint32_t match_empty_or_deleted() const {
+      uint32_t res = 0;
+      for (size_t i = 0; i < 8; ++i) {
+        res |= (ctrl_[i] < -1) << i;
+      }
+      return res;
+    }
+   private:
+    ctrl_type ctrl_[8];
+  };
+#endif
+
+  template <bool Const>
+  class basic_iterator {
+    friend class HashTable;
+
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef typename HashTable::value_type value_type;
+    typedef ptrdiff_t difference_type;
+    typedef typename std::conditional < Const || Policy::constant_elements(),
+            const value_type, value_type >::type element_type;
+    typedef element_type& reference;
+    typedef element_type* pointer;
+
+    basic_iterator() : ctrl_(nullptr), end_(nullptr), slot_(nullptr) { }
+    /** Conversion from iterator to const_iterator. */
+    template <bool C2, typename = typename std::enable_if<Const && !C2>::type>
+    basic_iterator(const basic_iterator<C2>& rhs) :
+      ctrl_(rhs.ctrl_), end_(rhs.end_), slot_(rhs.slot_) { }
+
+    reference operator*() const {
+      return Policy::element(*slot_);
+    }
+    pointer operator->() const {
+      return &Policy::element(*slot_);
+    }
+
+    basic_iterator& operator++() {
+      ++ctrl_;
+      ++slot_;
+      skip();
+      return *this;
+    }
+    basic_iterator operator++(int) {
+      auto ret = *this;
+      ++(*this);
+      return ret;
+    }
+
+    bool operator==(const basic_iterator& rhs) const {
+      return ctrl_ == rhs.ctrl_;
+    }
+    bool operator!=(const basic_iterator& rhs) const {
+      return ctrl_ != rhs.ctrl_;
+    }
+
+   private:
+    template <bool C2>
+    friend class basic_iterator;
+
+    basic_iterator(const ctrl_type* ctrl, const ctrl_type* end, slot_type* slot) :
+      ctrl_(ctrl), end_(end), slot_(slot) { }
+
+    void skip() {
+      while (ctrl_ != end_ && *ctrl_ < 0) {
+        ++ctrl_;
+        ++slot_;
+      }
+    }
+
+    const ctrl_type* ctrl_;
+    const ctrl_type* end_;
+    slot_type* slot_;
+  };
+
+ public:
+  typedef basic_iterator<false> iterator;
+  typedef basic_iterator<true> const_iterator;
+
+  HashTable() :
+    ctrl_(nullptr), slots_(nullptr), capacity_(0), size_(0), deleted_(0), rehashes_(0) { }
+
+  template <typename InputIterator>
+  HashTable(InputIterator first, InputIterator last) : HashTable() {
+    insert(first, last);
+  }
+
+  HashTable(std::initializer_list<init_type> il) : HashTable() {
+    insert(il);
+  }
+
+  HashTable(const HashTable& rhs) :
+    HashTable() {
+    hasher_ = rhs.hasher_;
+    eq_ = rhs.eq_;
+    reserve(rhs.size());
+    for (const auto& v : rhs) {
+      insert(v);
+    }
+  }
+
+  HashTable(HashTable&& rhs) : HashTable() {
+    swap(rhs);
+  }
+
+  HashTable& operator=(const HashTable& rhs) {
+    HashTable(rhs).swap(*this);
+    return *this;
+  }
+
+  HashTable& operator=(HashTable&& rhs) {
+    HashTable(std::move(rhs)).swap(*this);
+    return *this;
+  }
+
+  ~HashTable() {
+    destroy_slots();
+    deallocate(ctrl_, slots_, capacity_);
+  }
+
+  iterator begin() {
+    return iterator_at(0, true);
+  }
+  const_iterator begin() const {
+    return const_cast<HashTable*>(this)->begin();
+  }
+  const_iterator cbegin() const {
+    return begin();
+  }
+  iterator end() {
+    return iterator_at(capacity_, false);
+  }
+  const_iterator end() const {
+    return const_cast<HashTable*>(this)->end();
+  }
+  const_iterator cend() const {
+    return end();
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+  size_type size() const {
+    return size_;
+  }
+  size_type max_size() const {
+    return std::numeric_limits<size_type>::max() / sizeof(slot_type);
+  }
+
+  /** Number of slots; there are no buckets in an open addressing table. */
+  size_type bucket_count() const {
+    return capacity_;
+  }
+  float load_factor() const {
+    return capacity_ == 0 ? 0.0 : float(size_) / capacity_;
+  }
+  /** The table grows once it would be more than 7/8 full. */
+  float max_load_factor() const {
+    return 0.875;
+  }
+
+  /** Total bytes used by this table: the object itself, the control and slot
+      arrays, per-element nodes (for node-based policies) and any heap memory
+      owned by the elements. */
+  size_t memory_usage() const {
+    size_t res = sizeof(*this);
+    if (capacity_ > 0) {
+      res += malloc_size(capacity_ + group_width()) + malloc_size(capacity_ * sizeof(slot_type));
+    }
+    res += size_ * malloc_size(Policy::node_size());
+    return res + element_memory_usage<value_type>(begin(), end());
+  }
+
+  /** Load, tombstone, rehash and probe length statistics. */
+  HashStats hash_stats() const {
+    HashStats stats;
+    stats.size = size_;
+    stats.capacity = capacity_;
+    stats.load_factor = load_factor();
+    stats.tombstones = deleted_;
+    stats.rehashes = rehashes_;
+
+    size_t total = 0;
+    for (size_t i = 0; i < capacity_; ++i) {
+      if (ctrl_[i] >= 0) {
+        const auto n = probe_length(hash(Policy::key(slots_[i])), i);
+        total += n;
+        stats.max_probe_length = std::max(stats.max_probe_length, n);
+      }
+    }
+    stats.mean_probe_length = size_ == 0 ? 0 : double(total) / size_;
+    return stats;
+  }
+
+  void clear() {
+    destroy_slots();
+    if (capacity_ > 0) {
+      std::memset(ctrl_, empty_ctrl(), capacity_ + group_width());
+    }
+    size_ = 0;
+    deleted_ = 0;
+  }
+
+  /** Allocates enough slots to hold n elements without rehashing. */
+  void reserve(size_type n) {
+    const auto cap = capacity_for(n);
+    if (cap > capacity_) {
+      resize(cap);
+    }
+  }
+
+  void rehash(size_type n) {
+    resize(std::max(capacity_for(size_), n == 0 ? 0 : capacity_for(n)));
+  }
+
+  std::pair<iterator, bool> insert(init_type v) {
+    const auto h = hash(Policy::init_key(v));
+    const auto i = find_index(Policy::init_key(v), h);
+    if (i != capacity_) {
+      return std::make_pair(iterator_at(i, false), false);
+    }
+    return std::make_pair(iterator_at(insert_new(h, std::move(v)), false), true);
+  }
+
+  iterator insert(const_iterator, init_type v) {
+    return insert(std::move(v)).first;
+  }
+
+  template <typename InputIterator>
+  void insert(InputIterator first, InputIterator last) {
+    for (; first != last; ++first) {
+      insert(*first);
+    }
+  }
+
+  void insert(std::initializer_list<init_type> il) {
+    reserve(size_ + il.size());
+    insert(il.begin(), il.end());
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args&& ... args) {
+    return insert(init_type(std::forward<Args>(args)...));
+  }
+
+  template <typename... Args>
+  iterator emplace_hint(const_iterator, Args&& ... args) {
+    return emplace(std::forward<Args>(args)...).first;
+  }
+
+  iterator erase(const_iterator pos) {
+    const size_t i = pos.ctrl_ - ctrl_;
+    erase_index(i);
+    return iterator_at(i, true);
+  }
+
+  iterator erase(iterator pos) {
+    return erase(const_iterator(pos));
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    while (first != last) {
+      first = erase(first);
+    }
+    return iterator_at(last.ctrl_ - ctrl_, false);
+  }
+
+  size_type erase(const key_type& k) {
+    const auto i = find_index(k, hash(k));
+    if (i == capacity_) {
+      return 0;
+    }
+    erase_index(i);
+    return 1;
+  }
+
+  iterator find(const key_type& k) {
+    return iterator_at(find_index(k, hash(k)), false);
+  }
+  const_iterator find(const key_type& k) const {
+    return const_cast<HashTable*>(this)->find(k);
+  }
+  size_type count(const key_type& k) const {
+    return find_index(k, hash(k)) == capacity_ ? 0 : 1;
+  }
+
+  hasher hash_function() const {
+    return hasher_;
+  }
+  key_equal key_eq() const {
+    return eq_;
+  }
+
+  void swap(HashTable& rhs) {
+    std::swap(ctrl_, rhs.ctrl_);
+    std::swap(slots_, rhs.slots_);
+    std::swap(capacity_, rhs.capacity_);
+    std::swap(size_, rhs.size_);
+    std::swap(deleted_, rhs.deleted_);
+    std::swap(rehashes_, rhs.rehashes_);
+    std::swap(hasher_, rhs.hasher_);
+    std::swap(eq_, rhs.eq_);
+  }
+
+ protected:
+  /** Returns the index of k's slot, or capacity_ if k is not present. */
+  size_t find_index(const key_type& k, size_t h) const {
+    if (capacity_ == 0) {
+      return capacity_;
+    }
+    const ctrl_type h2 = h & 0x7f;
+    const size_t mask = capacity_ - 1;
+    size_t pos = (h >> 7) & mask;
+    for (size_t step = group_width(); ; step += group_width()) {
+      const Group g(ctrl_ + pos);
+      for (uint64_t m = g.match(h2); m != 0; m &= m - 1) {
+        const auto i = (pos + BitManip<uint64_t>::ntz(m)) & mask;
+        if (eq_(Policy::key(slots_[i]), k)) {
+          return i;
+        }
+      }
+      if (g.match_empty() != 0) {
+        return capacity_;
+      }
+      pos = (pos + step) & mask;
+    }
+  }
+
+  /** Inserts a key known not to be present and returns its slot index. */
+  size_t insert_new(size_t h, init_type&& v) {
+    if (capacity_ == 0) {
+      resize(group_width());
+    } else if ((size_ + deleted_ + 1) * 8 > capacity_ * 7) {
+      // Reclaim tombstones in place if that leaves enough room; otherwise grow.
+      resize(size_ * 16 <= capacity_ * 7 ? capacity_ : capacity_ * 2);
+    }
+    const auto i = find_insert_index(h);
+    if (ctrl_[i] == deleted_ctrl()) {
+      --deleted_;
+    }
+    set_ctrl(i, h & 0x7f);
+    Policy::construct(slots_ + i, std::move(v));
+    ++size_;
+    return i;
+  }
+
+  size_t hash(const key_type& k) const {
+    // std::hash is the identity for integers; mix so that both the low bits
+    // (used as control words) and high bits (used as positions) vary.
+    uint64_t h = hasher_(k);
+    h *= 0x9e3779b97f4a7c15ull;
+    return h ^ (h >> 32);
+  }
+
+  iterator iterator_at(size_t i, bool skip) {
+    iterator ret(ctrl_ + i, ctrl_ + capacity_, slots_ + i);
+    if (skip) {
+      ret.skip();
+    }
+    return ret;
+  }
+
+  slot_type* slots() const {
+    return slots_;
+  }
+
+ private:
+  ctrl_type* ctrl_;
+  slot_type* slots_;
+  size_t capacity_;
+  size_t size_;
+  size_t deleted_;
+  size_t rehashes_;
+  Hash hasher_;
+  Eq eq_;
+
+  /** Capacities are powers of two no smaller than a group. */
+  static size_t capacity_for(size_t n) {
+    size_t cap = group_width();
+    while (cap * 7 < n * 8) {
+      cap *= 2;
+    }
+    return cap;
+  }
+
+  /** The first group_width() control words are mirrored past the end of the
+      array, so that a group can be loaded at any position without wrapping. */
+  void set_ctrl(size_t i, ctrl_type c) {
+    ctrl_[i] = c;
+    if (i < group_width()) {
+      ctrl_[capacity_ + i] = c;
+    }
+  }
+
+  size_t find_insert_index(size_t h) const {
+    const size_t mask = capacity_ - 1;
+    size_t pos = (h >> 7) & mask;
+    for (size_t step = group_width(); ; step += group_width()) {
+      const auto m = Group(ctrl_ + pos).match_empty_or_deleted();
+      if (m != 0) {
+        return (pos + BitManip<uint64_t>::ntz(m)) & mask;
+      }
+      pos = (pos + step) & mask;
+    }
+  }
+
+  /** Returns the number of groups loaded before reaching slot i. */
+  size_t probe_length(size_t h, size_t i) const {
+    const size_t mask = capacity_ - 1;
+    size_t pos = (h >> 7) & mask;
+    size_t n = 1;
+    for (size_t step = group_width(); ((i - pos) & mask) >= group_width(); step += group_width()) {
+      pos = (pos + step) & mask;
+      ++n;
+    }
+    return n;
+  }
+
+  void erase_index(size_t i) {
+    Policy::destroy(slots_ + i);
+    set_ctrl(i, deleted_ctrl());
+    --size_;
+    ++deleted_;
+  }
+
+  void resize(size_t cap) {
+    auto old_ctrl = ctrl_;
+    auto old_slots = slots_;
+    const auto old_capacity = capacity_;
+
+    ctrl_ = new ctrl_type[cap + group_width()];
+    std::memset(ctrl_, empty_ctrl(), cap + group_width());
+    slots_ = std::allocator<slot_type>().allocate(cap);
+    capacity_ = cap;
+    deleted_ = 0;
+    if (old_capacity > 0) {
+      ++rehashes_;
+    }
+
+    for (size_t i = 0; i < old_capacity; ++i) {
+      if (old_ctrl[i] >= 0) {
+        const auto h = hash(Policy::key(old_slots[i]));
+        const auto j = find_insert_index(h);
+        set_ctrl(j, h & 0x7f);
+        Policy::transfer(slots_ + j, old_slots + i);
+      }
+    }
+    deallocate(old_ctrl, old_slots, old_capacity);
+  }
+
+  void destroy_slots() {
+    for (size_t i = 0; i < capacity_; ++i) {
+      if (ctrl_[i] >= 0) {
+        Policy::destroy(slots_ + i);
+      }
+    }
+  }
+
+  static void deallocate(ctrl_type* ctrl, slot_type* slots, size_t capacity) {
+    if (capacity > 0) {
+      delete[] ctrl;
+      std::allocator<slot_type>().deallocate(slots, capacity);
+    }
+  }
+};
+
+} // namespace cpputil
+
+#endif
@@ -15,108 +15,147 @@
 #ifndef CPPUTIL_INCLUDE_CONTAINER_MAP_UTIL_H
 #define CPPUTIL_INCLUDE_CONTAINER_MAP_UTIL_H
 
+#include <algorithm>
 #include <cassert>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "include/container/hash_stats.h"
+#include "include/memory/memory_usage.h"
+#include "include/meta/is_contiguous_map.h"
 
 namespace cpputil {
 
 template <typename Map>
 class CppUtilMap : public Map {
- public:
-  typedef Map map_type;
-
-  class const_key_iterator {
+ private:
+  /** Projects the keys or values out of an underlying map iterator. The
+      projection inherits the iterator category of the underlying iterator,
+      so it is random access whenever the map is contiguous. */
+  template <typename Itr, typename V, bool Key>
+  class projection_iterator {
    public:
-    const_key_iterator() = delete;
-    const_key_iterator(const typename map_type::const_iterator& itr)
+    typedef typename std::iterator_traits<Itr>::iterator_category iterator_category;
+    typedef typename std::remove_const<V>::type value_type;
+    typedef typename std::iterator_traits<Itr>::difference_type difference_type;
+    typedef V* pointer;
+    typedef V& reference;
+
+    projection_iterator() : itr_() { }
+    projection_iterator(const Itr& itr)
       : itr_ {itr} { }
 
-    const_key_iterator& operator++() {
+    projection_iterator& operator++() {
       itr_++;
       return *this;
     }
 
-    const typename map_type::key_type& operator*() const {
-      return itr_->first;
+    projection_iterator operator++(int) {
+      auto ret = *this;
+      itr_++;
+      return ret;
     }
 
-    const typename map_type::key_type* operator->() const {
-      return &(itr_->first);
+    projection_iterator& operator--() {
+      itr_--;
+      return *this;
     }
 
-    bool operator==(const const_key_iterator& rhs) const {
-      return itr_ == rhs.itr_;
+    projection_iterator operator--(int) {
+      auto ret = *this;
+      itr_--;
+      return ret;
     }
 
-    bool operator!=(const const_key_iterator& rhs) const {
-      return itr_ != rhs.itr_;
+    projection_iterator& operator+=(difference_type n) {
+      itr_ += n;
+      return *this;
     }
 
-   private:
-    typename map_type::const_iterator itr_;
-  };
+    projection_iterator& operator-=(difference_type n) {
+      itr_ -= n;
+      return *this;
+    }
 
-  class value_iterator {
-   public:
-    value_iterator() = delete;
-    value_iterator(const typename map_type::iterator& itr)
-      : itr_ {itr} { }
+    projection_iterator operator+(difference_type n) const {
+      return projection_iterator(itr_ + n);
+    }
 
-    value_iterator& operator++() {
-      itr_++;
-      return *this;
+    projection_iterator operator-(difference_type n) const {
+      return projection_iterator(itr_ - n);
     }
 
-    typename map_type::mapped_type& operator*() const {
-      return itr_->second;
+    difference_type operator-(const projection_iterator& rhs) const {
+      return itr_ - rhs.itr_;
     }
 
-    typename map_type::mapped_type* operator->() const {
-      return &(itr_->second);
+    reference operator*() const {
+      return project(std::integral_constant<bool, Key>());
     }
 
-    bool operator==(const value_iterator& rhs) const {
-      return itr_ == rhs.itr_;
+    pointer operator->() const {
+      return &(**this);
     }
 
-    bool operator!=(const value_iterator& rhs) const {
-      return itr_ != rhs.itr_;
+    reference operator[](difference_type n) const {
+      return *(*this + n);
     }
 
-   private:
-    typename map_type::iterator itr_;
-  };
+    bool operator==(const projection_iterator& rhs) const {
+      return itr_ == rhs.itr_;
+    }
 
-  class const_value_iterator {
-   public:
-    const_value_iterator() = delete;
-    const_value_iterator(const typename map_type::const_iterator& itr)
-      : itr_ {itr} { }
+    bool operator!=(const projection_iterator& rhs) const {
+      return itr_ != rhs.itr_;
+    }
 
-    const_value_iterator& operator++() {
-      itr_++;
-      return *this;
+    bool operator<(const projection_iterator& rhs) const {
+      return itr_ < rhs.itr_;
     }
 
-    const typename map_type::mapped_type& operator*() const {
-      return itr_->second;
+    bool operator>(const projection_iterator& rhs) const {
+      return itr_ > rhs.itr_;
     }
 
-    const typename map_type::mapped_type* operator->() const {
-      return &(itr_->second);
+    bool operator<=(const projection_iterator& rhs) const {
+      return itr_ <= rhs.itr_;
     }
 
-    bool operator==(const const_value_iterator& rhs) const {
-      return itr_ == rhs.itr_;
+    bool operator>=(const projection_iterator& rhs) const {
+      return itr_ >= rhs.itr_;
     }
 
-    bool operator!=(const const_value_iterator& rhs) const {
-      return itr_ != rhs.itr_;
+    friend projection_iterator operator+(difference_type n, const projection_iterator& itr) {
+      return itr + n;
     }
 
    private:
-    typename map_type::const_iterator itr_;
+    Itr itr_;
+
+    reference project(std::true_type) const {
+      return itr_->first;
+    }
+
+    reference project(std::false_type) const {
+      return itr_->second;
+    }
   };
 
+ public:
+  typedef Map map_type;
+
+  typedef projection_iterator<typename map_type::const_iterator,
+          const typename map_type::key_type, true> const_key_iterator;
+  typedef projection_iterator<typename map_type::iterator,
+          typename map_type::mapped_type, false> value_iterator;
+  typedef projection_iterator<typename map_type::const_iterator,
+          const typename map_type::mapped_type, false> const_value_iterator;
+
+  typedef std::pair<typename map_type::const_iterator, typename map_type::const_iterator> chunk_type;
+
   const_key_iterator key_begin() const {
     return const_key_iterator(Map::begin());
   }
@@ -157,6 +196,70 @@ class CppUtilMap : public Map {
     return const_value_iterator(Map::cend());
   }
 
+  /** Copies every key to out, in iteration order. Contiguous maps are copied
+      straight from their key array, which std::copy can turn into a memmove. */
+  template <typename OutputIterator>
+  OutputIterator keys_to(OutputIterator out) const {
+    return keys_to(out, std::integral_constant<bool, is_contiguous_map<Map>::value>());
+  }
+
+  /** Copies every value to out, in iteration order. */
+  template <typename OutputIterator>
+  OutputIterator values_to(OutputIterator out) const {
+    return values_to(out, std::integral_constant<bool, is_contiguous_map<Map>::value>());
+  }
+
+  /** Splits the map into at most n contiguous ranges of roughly equal size.
+      This costs one walk over the map when its iterators are not random access. */
+  std::vector<chunk_type> chunks(size_t n) const {
+    std::vector<chunk_type> ret;
+    const size_t total = Map::size();
+    n = std::max<size_t>(1, std::min(n, total));
+
+    auto itr = Map::begin();
+    for (size_t i = 0; i < n; ++i) {
+      auto next = itr;
+      std::advance(next, total * (i + 1) / n - total * i / n);
+      ret.push_back(std::make_pair(itr, next));
+      itr = next;
+    }
+    return ret;
+  }
+
+  /** Invokes f(first, last) on one chunk per thread, concurrently. f must be
+      safe to call from multiple threads. Passing 0 uses every core. */
+  template <typename Fxn>
+  void parallel_for_each_chunk(Fxn f, size_t threads = 0) const {
+    if (threads == 0) {
+      threads = std::thread::hardware_concurrency();
+    }
+    const auto cs = chunks(threads);
+    if (cs.size() == 1) {
+      f(cs[0].first, cs[0].second);
+      return;
+    }
+
+    std::vector<std::thread> ts;
+    for (const auto& c : cs) {
+      ts.emplace_back([&f, c] {
+        f(c.first, c.second);
+      });
+    }
+    for (auto& t : ts) {
+      t.join();
+    }
+  }
+
+  /** Total bytes used by this map. See MemoryUsage for how Map is accounted. */
+  size_t memory_usage() const {
+    return sizeof(*this) + MemoryUsage<Map>()(*this);
+  }
+
+  /** Hash statistics for the underlying map; requires a hashed Map. */
+  HashStats hash_stats() const {
+    return HashProfiler<Map>()(*this);
+  }
+
   typename map_type::mapped_type& assert_at(const typename map_type::key_type& k) {
     assert(Map::find(k) != Map::end() && "Unrecognized key!");
     return Map::at(k);
@@ -171,6 +274,27 @@ class CppUtilMap : public Map {
     assert(Map::find(k) != Map::end() && "Unrecognized key!");
     return Map::erase(k);
   }
+
+ private:
+  template <typename OutputIterator>
+  OutputIterator keys_to(OutputIterator out, std::true_type) const {
+    return std::copy(Map::key_data(), Map::key_data() + Map::size(), out);
+  }
+
+  template <typename OutputIterator>
+  OutputIterator keys_to(OutputIterator out, std::false_type) const {
+    return std::copy(key_begin(), key_end(), out);
+  }
+
+  template <typename OutputIterator>
+  OutputIterator values_to(OutputIterator out, std::true_type) const {
+    return std::copy(Map::value_data(), Map::value_data() + Map::size(), out);
+  }
+
+  template <typename OutputIterator>
+  OutputIterator values_to(OutputIterator out, std::false_type) const {
+    return std::copy(value_begin(), value_end(), out);
+  }
 };
 
 } // namespace cpputil
@@ -0,0 +1,155 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_CONTAINER_RANGE_SET_H
+#define CPPUTIL_INCLUDE_CONTAINER_RANGE_SET_H
+
+#include <algorithm>
+#include <limits>
+#include <stddef.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cpputil {
+
+/** A set of integers stored as a sorted vector of disjoint, non-adjacent
+    closed ranges [lo, hi]. Its footprint is proportional to the number of
+    runs rather than the number of values, so { 0 ... 1000000000 } is a
+    single pair. Inserting at or past the last range, which is how sorted
+    input arrives, is amortized constant time. */
+template <typename T>
+class RangeSet {
+ public:
+  typedef T value_type;
+  typedef std::pair<T, T> range_type;
+  typedef typename std::vector<range_type>::const_iterator const_iterator;
+
+  RangeSet() : ranges_() { }
+
+  /** Inserts a single value. */
+  void insert(const T& v) {
+    insert(v, v);
+  }
+
+  /** Inserts the values lo through hi. */
+  void insert(T lo, T hi) {
+    if (hi < lo) {
+      return;
+    }
+    // Fast path: extend or append past the last range
+    if (ranges_.empty() || ranges_.back().second < lo) {
+      if (!ranges_.empty() && adjacent(ranges_.back().second, lo)) {
+        ranges_.back().second = hi;
+      } else {
+        ranges_.emplace_back(lo, hi);
+      }
+      return;
+    }
+
+    // Otherwise merge with every range that overlaps or touches [lo, hi]
+    auto i = std::lower_bound(ranges_.begin(), ranges_.end(), lo,
+    [](const range_type& r, const T& v) {
+      return r.second < v && !adjacent(r.second, v);
+    });
+    auto j = i;
+    for (; j != ranges_.end() && (j->first <= hi || adjacent(hi, j->first)); ++j) {
+      lo = std::min(lo, j->first);
+      hi = std::max(hi, j->second);
+    }
+    if (i == j) {
+      ranges_.insert(i, range_type(lo, hi));
+    } else {
+      *i = range_type(lo, hi);
+      ranges_.erase(i + 1, j);
+    }
+  }
+
+  /** Returns true if v is in the set. */
+  bool contains(const T& v) const {
+    auto i = std::upper_bound(ranges_.begin(), ranges_.end(), v,
+    [](const T& x, const range_type& r) {
+      return x < r.first;
+    });
+    return i != ranges_.begin() && v <= (--i)->second;
+  }
+
+  /** Returns the number of values in the set. A set holding every value of
+      a 64-bit type has 2^64 values, which wraps to 0. */
+  size_t size() const {
+    typedef typename std::make_unsigned<T>::type U;
+    size_t n = 0;
+    for (const auto& r : ranges_) {
+      n += size_t(U(U(r.second) - U(r.first))) + 1;
+    }
+    return n;
+  }
+  /** Returns the number of ranges in the set. */
+  size_t num_ranges() const {
+    return ranges_.size();
+  }
+  /** Returns true if the set is empty. */
+  bool empty() const {
+    return ranges_.empty();
+  }
+  /** Removes every value. */
+  void clear() {
+    ranges_.clear();
+  }
+
+  /** Range iterator. */
+  const_iterator begin() const {
+    return ranges_.begin();
+  }
+  /** Range iterator. */
+  const_iterator end() const {
+    return ranges_.end();
+  }
+
+  /** Equality. */
+  bool operator==(const RangeSet& rhs) const {
+    return ranges_ == rhs.ranges_;
+  }
+  /** Inequality. */
+  bool operator!=(const RangeSet& rhs) const {
+    return ranges_ != rhs.ranges_;
+  }
+
+  /** STL-compliant swap. */
+  void swap(RangeSet& rhs) {
+    ranges_.swap(rhs.ranges_);
+  }
+
+ private:
+  std::vector<range_type> ranges_;
+
+  /** Returns true if b is a + 1, without overflowing at the top of T. */
+  static bool adjacent(const T& a, const T& b) {
+    return a < std::numeric_limits<T>::max() && T(a + 1) == b;
+  }
+};
+
+} // namespace cpputil
+
+namespace std {
+
+/** STL-compliant swap. */
+template <typename T>
+void swap(cpputil::RangeSet<T>& lhs, cpputil::RangeSet<T>& rhs) {
+  lhs.swap(rhs);
+}
+
+} // namespace std
+
+#endif
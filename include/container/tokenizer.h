@@ -16,9 +16,14 @@
 #define CPPUTIL_INCLUDE_CONTAINER_TOKENIZER_H
 
 #include <algorithm>
+#include <functional>
+#include <iterator>
 #include <stdint.h>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "include/algorithm/parallel_sort.h"
 #include "include/container/bijection.h"
 
 namespace cpputil {
@@ -36,6 +41,49 @@ class Tokenizer {
 
   Tokenizer() : next_token_ {Token()} { }
 
+  /** Tokenizes the values in [first, last) in bulk. Tokens are assigned in
+      order of first occurrence, exactly as repeated calls to tokenize() would.
+      Rather than probing the maps once per value, the input is sorted and
+      deduplicated once and the result is handed to Bijection::assign(). If
+      parallel is set, all cores are used. Requires T to be less-than comparable. */
+  template <typename InputIterator>
+  Tokenizer(InputIterator first, InputIterator last, bool parallel = false) :
+    next_token_ {Token()} {
+    typedef std::pair<T, size_t> indexed_type;
+    const size_t threads = parallel ? 0 : 1;
+
+    std::vector<indexed_type> vals;
+    for (size_t i = 0; first != last; ++first, ++i) {
+      vals.emplace_back(*first, i);
+    }
+
+    const auto same_value = [](const indexed_type& a, const indexed_type& b) {
+      return a.first == b.first;
+    };
+    const auto by_index = [](const indexed_type& a, const indexed_type& b) {
+      return a.second < b.second;
+    };
+    parallel_sort(vals.begin(), vals.end(), std::less<indexed_type>(), threads);
+    vals.erase(std::unique(vals.begin(), vals.end(), same_value), vals.end());
+    parallel_sort(vals.begin(), vals.end(), by_index, threads);
+
+    std::vector<std::pair<T, Token>> tokens;
+    tokens.reserve(vals.size());
+    for (auto& v : vals) {
+      tokens.emplace_back(std::move(v.first), next_token_++);
+    }
+    vals.clear();
+    vals.shrink_to_fit();
+
+    contents_.assign(std::make_move_iterator(tokens.begin()),
+                     std::make_move_iterator(tokens.end()), parallel);
+  }
+
+  /** Presizes the underlying maps for n values. */
+  void reserve(size_type n) {
+    contents_.reserve(n);
+  }
+
   const_iterator tokenize(const_reference t) {
     const auto itr = contents_.domain_find(t);
     if (itr == contents_.end()) {
@@ -45,6 +93,15 @@ class Tokenizer {
     }
   }
 
+  /** Tokenizes every value in [first, last), presizing the maps when possible. */
+  template <typename InputIterator>
+  void tokenize(InputIterator first, InputIterator last) {
+    presize(first, last, typename std::iterator_traits<InputIterator>::iterator_category());
+    for (; first != last; ++first) {
+      tokenize(*first);
+    }
+  }
+
   const_iterator untokenize(token_type token) const {
     return contents_.range_find(token);
   }
@@ -78,6 +135,21 @@ class Tokenizer {
     next_token_ = Token();
   }
 
+  /** Total bytes used by this tokenizer. */
+  size_t memory_usage() const {
+    return sizeof(*this) - sizeof(contents_) + contents_.memory_usage();
+  }
+
+  /** Hash statistics for the value to token map. */
+  HashStats value_hash_stats() const {
+    return contents_.domain_hash_stats();
+  }
+
+  /** Hash statistics for the token to value map. */
+  HashStats token_hash_stats() const {
+    return contents_.range_hash_stats();
+  }
+
   void swap(Tokenizer& rhs) {
     contents_.swap(rhs.contents_);
     std::swap(next_token_, rhs.next_token);
@@ -86,6 +158,14 @@ class Tokenizer {
  private:
   Bijection<T, Token, TMap, TokenMap> contents_;
   Token next_token_;
+
+  template <typename InputIterator>
+  void presize(InputIterator first, InputIterator last, std::forward_iterator_tag) {
+    reserve(size() + std::distance(first, last));
+  }
+
+  template <typename InputIterator>
+  void presize(InputIterator, InputIterator, std::input_iterator_tag) { }
 };
 
 } // namespace cpputil
@@ -0,0 +1,196 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_DEBUG_PROFILER_H
+#define CPPUTIL_INCLUDE_DEBUG_PROFILER_H
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include "include/io/column.h"
+#include "include/io/console.h"
+#include "include/io/filterstream.h"
+#include "include/math/online_stats.h"
+#include "include/math/parallel_stats.h"
+#include "include/patterns/thread_shards.h"
+#include "include/system/cycle_clock.h"
+
+namespace cpputil {
+
+/** Collects the running times of named code regions. Every thread records
+    into its own shard of per-region OnlineStats, so recording never
+    contends with other threads and reports may be produced at any time. */
+class Profiler {
+ public:
+  /** Regions registered beyond this limit share the last id. */
+  static constexpr size_t max_regions() {
+    return 256;
+  }
+
+  /** Returns the id of a named region, registering it if necessary. Call
+      sites should cache the result (see CPPUTIL_PROFILE). */
+  static size_t region(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex());
+    auto& ns = names();
+    for (size_t i = 0, ie = ns.size(); i < ie; ++i) {
+      if (ns[i] == name) {
+        return i;
+      }
+    }
+    if (ns.size() + 1 < max_regions()) {
+      ns.push_back(name);
+      return ns.size() - 1;
+    }
+    ns.resize(max_regions(), "(other)");
+    return max_regions() - 1;
+  }
+
+  /** Records a running time in nanoseconds for a region. */
+  static void record(size_t id, double ns) {
+    shards().local().regions[id].push_back(ns);
+  }
+
+  /** Returns the running times of a region, merged across threads. */
+  static OnlineStats<double> stats(size_t id) {
+    OnlineStats<double> res;
+    shards().for_each([&res, id](const Shard & s) {
+      res.merge(s.regions[id].read());
+    });
+    return res;
+  }
+
+  /** Writes a table of every region's running times to Console::msg(). */
+  static void report() {
+    report(Console::msg());
+  }
+
+  /** Writes a table of every region's running times, in aligned columns. */
+  static void report(std::ostream& os) {
+    std::vector<std::string> ns;
+    {
+      std::lock_guard<std::mutex> lock(mutex());
+      ns = names();
+    }
+    std::vector<OnlineStats<double>> stats;
+    for (size_t i = 0, ie = ns.size(); i < ie; ++i) {
+      stats.push_back(Profiler::stats(i));
+    }
+
+    ofilterstream<Column> table(os);
+    table.filter().padding(2);
+    table << "region";
+    for (const auto& n : ns) {
+      table << std::endl << n;
+    }
+    table.filter().next();
+    table << "count";
+    for (const auto& s : stats) {
+      table << std::endl << s.size();
+    }
+
+    const char* headings[] = {"mean (ns)", "stddev (ns)", "min (ns)", "max (ns)", "total (ms)"};
+    for (size_t c = 0; c < 5; ++c) {
+      table.filter().next();
+      table << headings[c] << std::fixed << std::setprecision(c == 4 ? 3 : 1);
+      for (const auto& s : stats) {
+        table << std::endl;
+        if (s.size() == 0) {
+          table << "-";
+          continue;
+        }
+        switch (c) {
+        case 0:
+          table << s.mean();
+          break;
+        case 1:
+          table << std::sqrt(s.variance());
+          break;
+        case 2:
+          table << s.min();
+          break;
+        case 3:
+          table << s.max();
+          break;
+        default:
+          table << s.mean() * s.size() / 1e6;
+          break;
+        }
+      }
+    }
+    table.filter().done();
+    os << std::endl;
+  }
+
+ private:
+  struct Shard {
+    Shard() : regions(max_regions()) { }
+
+    std::vector<PublishedOnlineStats<double>> regions;
+  };
+
+  static ThreadShards<Shard>& shards() {
+    static ThreadShards<Shard> ss;
+    return ss;
+  }
+
+  static std::vector<std::string>& names() {
+    static std::vector<std::string> ns;
+    return ns;
+  }
+
+  static std::mutex& mutex() {
+    static std::mutex m;
+    return m;
+  }
+};
+
+/** Records the lifetime of this object to a Profiler region. */
+class ScopedTimer {
+ public:
+  explicit ScopedTimer(size_t id) : id_(id), start_(CycleClock::start()) { }
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+  ~ScopedTimer() {
+    Profiler::record(id_, CycleClock::to_ns(CycleClock::stop() - start_));
+  }
+
+ private:
+  const size_t id_;
+  const uint64_t start_;
+};
+
+} // namespace cpputil
+
+/** Times the remainder of the enclosing scope as the region name. The
+    region is registered once per call site. Unless DEBUG_PROFILER is
+    defined, this expands to nothing and costs nothing. */
+#ifdef DEBUG_PROFILER
+#define CPPUTIL_PROFILE_CAT_IMPL(x, y) x##y
+#define CPPUTIL_PROFILE_CAT(x, y) CPPUTIL_PROFILE_CAT_IMPL(x, y)
+#define CPPUTIL_PROFILE(name) \
+  static const size_t CPPUTIL_PROFILE_CAT(cpputil_region_, __LINE__) = \
+      cpputil::Profiler::region(name); \
+  cpputil::ScopedTimer CPPUTIL_PROFILE_CAT(cpputil_timer_, __LINE__)( \
+      CPPUTIL_PROFILE_CAT(cpputil_region_, __LINE__))
+#else
+#define CPPUTIL_PROFILE(name)
+#endif
+
+#endif
@@ -0,0 +1,83 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_IO_MEMBUF_H
+#define CPPUTIL_INCLUDE_IO_MEMBUF_H
+
+#include <iostream>
+#include <streambuf>
+
+namespace cpputil {
+
+/** A read-only streambuf over a range of memory that it does not own. The
+    range is exposed directly as the get area, so reading through it copies
+    nothing, and reset() retargets it without constructing a new stream. */
+template <typename Ch, typename Tr>
+class basic_membuf : public std::basic_streambuf<Ch, Tr> {
+ public:
+  typedef typename std::basic_streambuf<Ch, Tr>::char_type char_type;
+  typedef typename std::basic_streambuf<Ch, Tr>::int_type int_type;
+  typedef typename std::basic_streambuf<Ch, Tr>::off_type off_type;
+  typedef typename std::basic_streambuf<Ch, Tr>::pos_type pos_type;
+  typedef typename std::basic_streambuf<Ch, Tr>::traits_type traits_type;
+
+  basic_membuf() : std::basic_streambuf<Ch, Tr>() { }
+
+  basic_membuf(const char_type* begin, const char_type* end)
+    : std::basic_streambuf<Ch, Tr>() {
+    reset(begin, end);
+  }
+
+  virtual ~basic_membuf() { }
+
+  /** Replaces the range being read. */
+  void reset(const char_type* begin, const char_type* end) {
+    // The get area is never written through: putback of a different
+    // character falls through to pbackfail(), which refuses it.
+    auto b = const_cast<char_type*>(begin);
+    auto e = const_cast<char_type*>(end);
+    this->setg(b, b, e);
+  }
+
+ protected:
+  virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                           std::ios_base::openmode which = std::ios_base::in | std::ios_base::out) {
+    if (!(which & std::ios_base::in)) {
+      return pos_type(off_type(-1));
+    }
+    off_type pos = off;
+    if (dir == std::ios_base::cur) {
+      pos += this->gptr() - this->eback();
+    } else if (dir == std::ios_base::end) {
+      pos += this->egptr() - this->eback();
+    }
+    if (pos < 0 || pos > this->egptr() - this->eback()) {
+      return pos_type(off_type(-1));
+    }
+    this->setg(this->eback(), this->eback() + pos, this->egptr());
+    return pos_type(pos);
+  }
+
+  virtual pos_type seekpos(pos_type pos,
+                           std::ios_base::openmode which = std::ios_base::in | std::ios_base::out) {
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+  }
+};
+
+typedef basic_membuf<char, std::char_traits<char>> membuf;
+typedef basic_membuf<wchar_t, std::char_traits<wchar_t>> wmembuf;
+
+} // namespace cpputil
+
+#endif
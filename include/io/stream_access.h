@@ -0,0 +1,107 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_IO_STREAM_ACCESS_H
+#define CPPUTIL_INCLUDE_IO_STREAM_ACCESS_H
+
+#include <iostream>
+#include <locale>
+
+namespace cpputil {
+
+/** Exposes the get and put areas of a streambuf, so that formatting code can
+    read and write characters in place rather than through a virtual call.
+    A pointer to a protected member which is named through a derived class
+    may be applied to an instance of the base class. */
+struct StreamAccess : public std::streambuf {
+  /** The characters which can be read without refilling the buffer. */
+  static const char* get_begin(std::streambuf* sb) {
+    return (sb->*&StreamAccess::gptr)();
+  }
+  static const char* get_end(std::streambuf* sb) {
+    return (sb->*&StreamAccess::egptr)();
+  }
+  /** Consumes the characters before p, which must lie in the get area. */
+  static void get_consume(std::streambuf* sb, const char* p) {
+    (sb->*&StreamAccess::gbump)(int(p - get_begin(sb)));
+  }
+
+  /** Reads n characters, in place if they lie in the get area. */
+  static std::streamsize get(std::streambuf* sb, char* s, std::streamsize n) {
+    const auto p = get_begin(sb);
+    if (get_end(sb) - p >= n) {
+      std::char_traits<char>::copy(s, p, n);
+      (sb->*&StreamAccess::gbump)(int(n));
+      return n;
+    }
+    return sb->sgetn(s, n);
+  }
+
+  /** The space which can be written without flushing or growing the buffer. */
+  static char* put_begin(std::streambuf* sb) {
+    return (sb->*&StreamAccess::pptr)();
+  }
+  static char* put_end(std::streambuf* sb) {
+    return (sb->*&StreamAccess::epptr)();
+  }
+  /** Commits the characters before p, which must lie in the put area. */
+  static void put_commit(std::streambuf* sb, const char* p) {
+    (sb->*&StreamAccess::pbump)(int(p - put_begin(sb)));
+  }
+
+  /** Writes n characters, in place if they fit in the put area. */
+  static std::streamsize put(std::streambuf* sb, const char* s, std::streamsize n) {
+    const auto p = (sb->*&StreamAccess::pptr)();
+    if ((sb->*&StreamAccess::epptr)() - p >= n) {
+      std::char_traits<char>::copy(p, s, n);
+      (sb->*&StreamAccess::pbump)(int(n));
+      return n;
+    }
+    return sb->sputn(s, n);
+  }
+};
+
+inline int classic_locale_index() {
+  static const int idx = std::ios::xalloc();
+  return idx;
+}
+
+/** Returns true if ios formats numbers as the classic locale does. Comparing
+    locales costs a pair of atomic reference count updates, so the answer is
+    remembered in the stream and forgotten when a locale is imbued. */
+inline bool is_classic(std::ios_base& ios) {
+  enum {
+    unknown = 0,
+    classic,
+    other,
+    stale
+  };
+
+  auto& w = ios.iword(classic_locale_index());
+  if (w == unknown || w == stale) {
+    if (w == unknown) {
+      ios.register_callback([](std::ios_base::event e, std::ios_base & ios, int idx) {
+        if (e != std::ios_base::erase_event) {
+          ios.iword(idx) = stale;
+        }
+      }, classic_locale_index());
+    }
+    w = ios.getloc() == std::locale::classic() ? classic : other;
+  }
+  return w == classic;
+}
+
+} // namespace cpputil
+
+#endif
@@ -0,0 +1,85 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_LAZY_ASYNC_THUNK_H
+#define CPPUTIL_INCLUDE_LAZY_ASYNC_THUNK_H
+
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "include/lazy/future.h"
+#include "include/lazy/thread_pool.h"
+#include "include/lazy/thunk.h"
+
+namespace cpputil {
+
+/** A Thunk which is evaluated on a thread pool. Nothing runs until start()
+    or get() is first called; start() schedules the evaluation and returns
+    immediately, so independent thunks may be started together and then
+    evaluated in parallel. Copies refer to the same evaluation. */
+template <typename Fxn, typename... Args>
+class AsyncThunk {
+ public:
+  typedef typename Thunk<Fxn, Args...>::value_type value_type;
+
+  AsyncThunk(ThreadPool& pool, Fxn&& fxn, Args&& ... args) :
+    impl_(std::make_shared<Impl>(pool, std::forward<Fxn>(fxn), std::forward<Args>(args)...)) { }
+
+  /** Schedules evaluation, if it has not been already. */
+  Future<value_type> start() const {
+    auto impl = impl_;
+    std::call_once(impl_->once, [impl] {
+      impl->future = make_async(impl->pool, [impl] {
+        return impl->thunk.get();
+      });
+    });
+    return impl_->future;
+  }
+
+  /** Returns the result, starting evaluation and waiting if necessary. */
+  const value_type& get() const {
+    return start().get();
+  }
+
+  operator const value_type& () const {
+    return get();
+  }
+
+  bool started() const {
+    return impl_->future.valid();
+  }
+
+ private:
+  struct Impl {
+    Impl(ThreadPool& p, Fxn&& fxn, Args&& ... args) :
+      pool(p), thunk(std::forward<Fxn>(fxn), std::forward<Args>(args)...) { }
+
+    ThreadPool& pool;
+    Thunk<Fxn, Args...> thunk;
+    std::once_flag once;
+    Future<value_type> future;
+  };
+
+  std::shared_ptr<Impl> impl_;
+};
+
+template <typename Fxn, typename... Args>
+AsyncThunk<Fxn, Args...> make_async_thunk(ThreadPool& pool, Fxn&& fxn, Args&& ... args) {
+  return {pool, std::forward<Fxn>(fxn), std::forward<Args>(args)...};
+}
+
+} // namespace cpputil
+
+#endif
@@ -0,0 +1,245 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_LAZY_FUTURE_H
+#define CPPUTIL_INCLUDE_LAZY_FUTURE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "include/lazy/thread_pool.h"
+
+namespace cpputil {
+
+/** The state shared by a Future and the task which fulfills it. Everything
+    but the stored value is common to every result type. */
+class FutureStateBase {
+ public:
+  FutureStateBase() : ready_(false) { }
+
+  bool ready() const {
+    return ready_.load(std::memory_order_acquire);
+  }
+
+  /** Blocks until the result is available. Pool workers run other tasks
+      while they wait. */
+  void wait() {
+    if (ready()) {
+      return;
+    }
+    if (auto pool = ThreadPool::current()) {
+      pool->wait_until([this] {
+        return ready();
+      });
+      return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] {
+      return ready();
+    });
+  }
+
+  /** Invokes c once the result is available (immediately, if it already is). */
+  void on_ready(std::function<void()> c) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!ready()) {
+        continuations_.push_back(std::move(c));
+        return;
+      }
+    }
+    c();
+  }
+
+  void fail(std::exception_ptr e) {
+    error_ = e;
+    complete();
+  }
+
+  std::exception_ptr error() const {
+    return error_;
+  }
+
+ protected:
+  void complete() {
+    std::vector<std::function<void()>> cs;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ready_.store(true, std::memory_order_release);
+      cs.swap(continuations_);
+    }
+    cv_.notify_all();
+    for (auto& c : cs) {
+      c();
+    }
+  }
+
+ private:
+  std::atomic<bool> ready_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::exception_ptr error_;
+  std::vector<std::function<void()>> continuations_;
+};
+
+template <typename T>
+class FutureState : public FutureStateBase {
+ public:
+  typedef const T& reference;
+
+  /** The result type of a continuation f applied to this state's value. */
+  template <typename Fxn>
+  struct result {
+    typedef typename std::result_of<Fxn(const T&)>::type type;
+  };
+
+  /** Stores the result of f(), or the exception it throws. */
+  template <typename Fxn>
+  void run(Fxn& f) {
+    try {
+      value_.reset(new T(f()));
+    } catch (...) {
+      fail(std::current_exception());
+      return;
+    }
+    complete();
+  }
+
+  template <typename Fxn>
+  typename result<Fxn>::type apply(Fxn& f) const {
+    return f(*value_);
+  }
+
+  reference get() const {
+    return *value_;
+  }
+
+ private:
+  std::unique_ptr<T> value_;
+};
+
+template <>
+class FutureState<void> : public FutureStateBase {
+ public:
+  typedef void reference;
+
+  template <typename Fxn>
+  struct result {
+    typedef typename std::result_of<Fxn()>::type type;
+  };
+
+  template <typename Fxn>
+  void run(Fxn& f) {
+    try {
+      f();
+    } catch (...) {
+      fail(std::current_exception());
+      return;
+    }
+    complete();
+  }
+
+  template <typename Fxn>
+  typename result<Fxn>::type apply(Fxn& f) const {
+    return f();
+  }
+
+  void get() const { }
+};
+
+/** A handle on the result of an asynchronous computation. Futures are
+    cheap to copy; every copy refers to the same result. */
+template <typename T>
+class Future {
+ public:
+  typedef T value_type;
+
+  Future() { }
+  explicit Future(std::shared_ptr<FutureState<T>> state) : state_(std::move(state)) { }
+
+  /** Returns false for a default-constructed future. */
+  bool valid() const {
+    return state_ != nullptr;
+  }
+
+  bool ready() const {
+    return state_->ready();
+  }
+
+  void wait() const {
+    state_->wait();
+  }
+
+  /** Waits for the result and returns it, or rethrows the exception which
+      the computation threw. */
+  typename FutureState<T>::reference get() const {
+    state_->wait();
+    if (state_->error()) {
+      std::rethrow_exception(state_->error());
+    }
+    return state_->get();
+  }
+
+  /** Schedules f on pool once this result is available, passing it the
+      result (or nothing, for Future<void>). If this computation throws, f is
+      skipped and the returned future holds the same exception. */
+  template <typename Fxn>
+  Future<typename FutureState<T>::template result<Fxn>::type> then(ThreadPool& pool, Fxn f) const {
+    typedef typename FutureState<T>::template result<Fxn>::type U;
+    auto self = state_;
+    auto next = std::make_shared<FutureState<U>>();
+    auto p = &pool;
+    state_->on_ready([p, self, next, f] {
+      p->submit([self, next, f]() mutable {
+        if (self->error()) {
+          next->fail(self->error());
+          return;
+        }
+        auto g = [&self, &f]() -> U {
+          return self->apply(f);
+        };
+        next->run(g);
+      });
+    });
+    return Future<U>(next);
+  }
+
+ private:
+  std::shared_ptr<FutureState<T>> state_;
+};
+
+/** Runs fxn(args...) on pool and returns a future for its result. The
+    arguments are copied. */
+template <typename Fxn, typename... Args>
+Future<typename std::result_of<Fxn(Args...)>::type>
+make_async(ThreadPool& pool, Fxn fxn, Args... args) {
+  typedef typename std::result_of<Fxn(Args...)>::type T;
+  auto state = std::make_shared<FutureState<T>>();
+  auto task = std::bind(fxn, args...);
+  pool.submit([state, task]() mutable {
+    state->run(task);
+  });
+  return Future<T>(state);
+}
+
+} // namespace cpputil
+
+#endif
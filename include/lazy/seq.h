@@ -0,0 +1,332 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_LAZY_SEQ_H
+#define CPPUTIL_INCLUDE_LAZY_SEQ_H
+
+#include <iterator>
+#include <stddef.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cpputil {
+
+/** Lazy, pull-based sequences. A sequence produces its values one at a time
+    through bool next(value_type& v), which stores the next value in v or
+    returns false once the sequence is exhausted. Adaptors (map, filter, take,
+    chunk, zip) wrap a sequence by value and do their work inside next(), so
+    a pipeline compiles down to a single fused loop and no intermediate
+    containers are built. Sequences over iterators only require that the
+    iterators support *, ++ and != (as, for example, BitString's set-bit
+    index iterators do), and hold them by value: the underlying container
+    must outlive the sequence.
+
+    for (auto w : make_seq(words).filter(is_long).map(to_upper).take(10)) { ... } */
+template <typename Derived>
+class Seq;
+
+template <typename S, typename Fxn>
+class MapSeq;
+template <typename S, typename Pred>
+class FilterSeq;
+template <typename S>
+class TakeSeq;
+template <typename S>
+class ChunkSeq;
+template <typename S1, typename S2>
+class ZipSeq;
+
+/** The type of a sequence element which is produced from an element of type
+    T. Associative containers' const keys are dropped so values may be reused. */
+template <typename T>
+struct seq_value_helper {
+  typedef T type;
+};
+
+template <typename K, typename V>
+struct seq_value_helper<std::pair<const K, V>> {
+  typedef std::pair<K, V> type;
+};
+
+template <typename T>
+struct seq_value : seq_value_helper<typename std::decay<T>::type> { };
+
+template <typename Derived>
+class Seq {
+ public:
+  /** An input iterator for use with range-based for. */
+  class iterator {
+   public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef typename Derived::value_type value_type;
+    typedef ptrdiff_t difference_type;
+    typedef const value_type* pointer;
+    typedef const value_type& reference;
+
+    iterator() : seq_(nullptr) { }
+    explicit iterator(Derived* seq) : seq_(seq) {
+      ++*this;
+    }
+
+    reference operator*() const {
+      return val_;
+    }
+    pointer operator->() const {
+      return &val_;
+    }
+
+    iterator& operator++() {
+      if (!seq_->next(val_)) {
+        seq_ = nullptr;
+      }
+      return *this;
+    }
+
+    bool operator==(const iterator& rhs) const {
+      return seq_ == rhs.seq_;
+    }
+    bool operator!=(const iterator& rhs) const {
+      return seq_ != rhs.seq_;
+    }
+
+   private:
+    Derived* seq_;
+    value_type val_;
+  };
+
+  /** Begins consuming the sequence. */
+  iterator begin() {
+    return iterator(&derived());
+  }
+
+  iterator end() {
+    return iterator();
+  }
+
+  /** Applies f to every element. */
+  template <typename Fxn>
+  MapSeq<Derived, Fxn> map(Fxn f) const {
+    return MapSeq<Derived, Fxn>(derived(), f);
+  }
+
+  /** Keeps only the elements which satisfy p. */
+  template <typename Pred>
+  FilterSeq<Derived, Pred> filter(Pred p) const {
+    return FilterSeq<Derived, Pred>(derived(), p);
+  }
+
+  /** Keeps only the first n elements. */
+  TakeSeq<Derived> take(size_t n) const {
+    return TakeSeq<Derived>(derived(), n);
+  }
+
+  /** Groups elements into vectors of n (the last may be shorter). */
+  ChunkSeq<Derived> chunk(size_t n) const {
+    return ChunkSeq<Derived>(derived(), n);
+  }
+
+  /** Pairs elements with those of s, stopping when either runs out. */
+  template <typename S>
+  ZipSeq<Derived, S> zip(const S& s) const {
+    return ZipSeq<Derived, S>(derived(), s);
+  }
+
+  /** Consumes the sequence, invoking f on every element. */
+  template <typename Fxn>
+  void for_each(Fxn f) {
+    typename Derived::value_type v;
+    while (derived().next(v)) {
+      f(v);
+    }
+  }
+
+  /** Consumes the sequence, combining its elements with f. */
+  template <typename T, typename Fxn>
+  T reduce(T init, Fxn f) {
+    typename Derived::value_type v;
+    while (derived().next(v)) {
+      init = f(init, v);
+    }
+    return init;
+  }
+
+  /** Consumes the sequence and returns the number of elements. */
+  size_t count() {
+    size_t res = 0;
+    typename Derived::value_type v;
+    while (derived().next(v)) {
+      ++res;
+    }
+    return res;
+  }
+
+  /** Consumes the sequence into a vector. */
+  template <typename S = Derived>
+  std::vector<typename S::value_type> to_vector() {
+    std::vector<typename S::value_type> res;
+    typename S::value_type v;
+    while (derived().next(v)) {
+      res.push_back(v);
+    }
+    return res;
+  }
+
+ private:
+  Derived& derived() {
+    return static_cast<Derived&>(*this);
+  }
+  const Derived& derived() const {
+    return static_cast<const Derived&>(*this);
+  }
+};
+
+/** The elements of [first, last). */
+template <typename Itr>
+class RangeSeq : public Seq<RangeSeq<Itr>> {
+ public:
+  typedef typename seq_value<decltype(*std::declval<Itr>())>::type value_type;
+
+  RangeSeq(Itr first, Itr last) : itr_(first), end_(last) { }
+
+  bool next(value_type& v) {
+    if (!(itr_ != end_)) {
+      return false;
+    }
+    v = *itr_;
+    ++itr_;
+    return true;
+  }
+
+ private:
+  Itr itr_;
+  Itr end_;
+};
+
+template <typename S, typename Fxn>
+class MapSeq : public Seq<MapSeq<S, Fxn>> {
+ public:
+  typedef typename seq_value<typename std::result_of<Fxn(const typename S::value_type&)>::type>::type
+  value_type;
+
+  MapSeq(const S& s, Fxn f) : src_(s), fxn_(f) { }
+
+  bool next(value_type& v) {
+    if (!src_.next(buf_)) {
+      return false;
+    }
+    v = fxn_(buf_);
+    return true;
+  }
+
+ private:
+  S src_;
+  Fxn fxn_;
+  /** Reused across calls, so that e.g. strings keep their capacity. */
+  typename S::value_type buf_;
+};
+
+template <typename S, typename Pred>
+class FilterSeq : public Seq<FilterSeq<S, Pred>> {
+ public:
+  typedef typename S::value_type value_type;
+
+  FilterSeq(const S& s, Pred p) : src_(s), pred_(p) { }
+
+  bool next(value_type& v) {
+    while (src_.next(v)) {
+      if (pred_(v)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  S src_;
+  Pred pred_;
+};
+
+template <typename S>
+class TakeSeq : public Seq<TakeSeq<S>> {
+ public:
+  typedef typename S::value_type value_type;
+
+  TakeSeq(const S& s, size_t n) : src_(s), n_(n) { }
+
+  bool next(value_type& v) {
+    if (n_ == 0) {
+      return false;
+    }
+    --n_;
+    return src_.next(v);
+  }
+
+ private:
+  S src_;
+  size_t n_;
+};
+
+template <typename S>
+class ChunkSeq : public Seq<ChunkSeq<S>> {
+ public:
+  typedef std::vector<typename S::value_type> value_type;
+
+  ChunkSeq(const S& s, size_t n) : src_(s), n_(n == 0 ? 1 : n) { }
+
+  bool next(value_type& v) {
+    v.resize(n_);
+    size_t i = 0;
+    for (; i < n_ && src_.next(v[i]); ++i);
+    v.resize(i);
+    return i > 0;
+  }
+
+ private:
+  S src_;
+  size_t n_;
+};
+
+template <typename S1, typename S2>
+class ZipSeq : public Seq<ZipSeq<S1, S2>> {
+ public:
+  typedef std::pair<typename S1::value_type, typename S2::value_type> value_type;
+
+  ZipSeq(const S1& s1, const S2& s2) : src1_(s1), src2_(s2) { }
+
+  bool next(value_type& v) {
+    return src1_.next(v.first) && src2_.next(v.second);
+  }
+
+ private:
+  S1 src1_;
+  S2 src2_;
+};
+
+/** Returns a sequence over [first, last). */
+template <typename Itr>
+RangeSeq<Itr> make_seq(Itr first, Itr last) {
+  return RangeSeq<Itr>(first, last);
+}
+
+/** Returns a sequence over the elements of a container (such as a vector,
+    a Tokenizer or a Bijection), which must outlive the sequence. */
+template <typename C>
+RangeSeq<typename C::const_iterator> make_seq(const C& c) {
+  return RangeSeq<typename C::const_iterator>(c.begin(), c.end());
+}
+
+} // namespace cpputil
+
+#endif
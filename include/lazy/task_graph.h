@@ -0,0 +1,130 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_LAZY_TASK_GRAPH_H
+#define CPPUTIL_INCLUDE_LAZY_TASK_GRAPH_H
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stddef.h>
+#include <vector>
+
+#include "include/lazy/thread_pool.h"
+
+namespace cpputil {
+
+/** A set of tasks with dependencies between them. Since a task may only
+    depend on tasks which were added before it, the graph is acyclic by
+    construction. run() starts every task with no dependencies on a thread
+    pool, and each completing task starts those of its dependents which have
+    become ready, so independent tasks always run concurrently. */
+class TaskGraph {
+ public:
+  typedef size_t task_id;
+
+  /** Adds a task which may start once every task in deps has finished.
+      Returns its id, or -1 if deps names a task which does not exist yet. */
+  task_id add(std::function<void()> f, const std::vector<task_id>& deps = {}) {
+    const auto id = nodes_.size();
+    for (auto d : deps) {
+      if (d >= id) {
+        return task_id(-1);
+      }
+    }
+    nodes_.emplace_back(new Node(std::move(f), deps.size()));
+    for (auto d : deps) {
+      nodes_[d]->dependents.push_back(id);
+    }
+    return id;
+  }
+
+  size_t size() const {
+    return nodes_.size();
+  }
+
+  /** Runs every task and blocks until all have finished; the calling thread
+      helps run tasks while it waits. If any task throws, tasks which have
+      not yet started are skipped and the first exception is rethrown. The
+      graph may be run again afterwards. */
+  void run(ThreadPool& pool) {
+    error_ = nullptr;
+    failed_.store(false, std::memory_order_relaxed);
+    remaining_.store(nodes_.size(), std::memory_order_relaxed);
+    for (auto& n : nodes_) {
+      n->waiting.store(n->dependencies, std::memory_order_relaxed);
+    }
+    for (size_t i = 0, ie = nodes_.size(); i < ie; ++i) {
+      if (nodes_[i]->dependencies == 0) {
+        schedule(pool, i);
+      }
+    }
+    pool.wait_until([this] {
+      return remaining_.load(std::memory_order_acquire) == 0;
+    });
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+ private:
+  struct Node {
+    Node(std::function<void()> f, size_t deps) : fxn(std::move(f)), dependencies(deps), waiting(0) { }
+
+    std::function<void()> fxn;
+    std::vector<task_id> dependents;
+    const size_t dependencies;
+    std::atomic<size_t> waiting;
+  };
+
+  std::vector<std::unique_ptr<Node>> nodes_;
+  std::atomic<size_t> remaining_;
+  std::atomic<bool> failed_;
+  std::mutex error_mutex_;
+  std::exception_ptr error_;
+
+  void schedule(ThreadPool& pool, task_id id) {
+    auto p = &pool;
+    pool.submit([this, p, id] {
+      execute(*p, id);
+    });
+  }
+
+  void execute(ThreadPool& pool, task_id id) {
+    auto& n = *nodes_[id];
+    if (!failed_.load(std::memory_order_acquire)) {
+      try {
+        n.fxn();
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        if (!error_) {
+          error_ = std::current_exception();
+        }
+        failed_.store(true, std::memory_order_release);
+      }
+    }
+    for (auto d : n.dependents) {
+      if (nodes_[d]->waiting.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        schedule(pool, d);
+      }
+    }
+    remaining_.fetch_sub(1, std::memory_order_release);
+  }
+};
+
+} // namespace cpputil
+
+#endif
@@ -0,0 +1,203 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_LAZY_THREAD_POOL_H
+#define CPPUTIL_INCLUDE_LAZY_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stddef.h>
+#include <thread>
+#include <vector>
+
+namespace cpputil {
+
+/** A work-stealing thread pool. Each worker owns a task queue: tasks
+    submitted by a worker go to the back of its own queue and are popped from
+    the back (most recent first, which keeps dependent work cache-warm).
+    Tasks submitted from other threads go to a shared queue. An idle worker
+    takes from its own queue, then the shared queue, and then steals the
+    oldest task from another worker. Threads waiting on pool work (see
+    wait_until()) run tasks while they wait, so waiting inside a task cannot
+    deadlock the pool. The destructor runs every queued task before joining. */
+class ThreadPool {
+ public:
+  /** Passing 0 uses one thread per core. */
+  explicit ThreadPool(size_t threads = 0) : pending_(0), stop_(false) {
+    if (threads == 0) {
+      threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+      queues_.emplace_back(new Queue());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+      threads_.emplace_back([this, i] {
+        work(i);
+      });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      stop_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (auto& t : threads_) {
+      t.join();
+    }
+  }
+
+  size_t size() const {
+    return threads_.size();
+  }
+
+  /** Schedules a task. Tasks should not throw. */
+  void submit(std::function<void()> task) {
+    auto& q = current() == this ? *queues_[index()] : shared_;
+    {
+      std::lock_guard<std::mutex> lock(q.mutex);
+      q.tasks.push_back(std::move(task));
+    }
+    pending_.fetch_add(1, std::memory_order_release);
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    sleep_cv_.notify_one();
+  }
+
+  /** Runs one queued task on the calling thread, if there is one. */
+  bool try_run_one() {
+    std::function<void()> task;
+    if (!take(current() == this ? index() : queues_.size(), task)) {
+      return false;
+    }
+    task();
+    return true;
+  }
+
+  /** Runs queued tasks on the calling thread until pred() holds. When there
+      is nothing to run, the thread naps until a task is submitted, polling
+      pred() every 100us. */
+  template <typename Pred>
+  void wait_until(Pred pred) {
+    while (!pred()) {
+      if (!try_run_one()) {
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleep_cv_.wait_for(lock, std::chrono::microseconds(100), [this] {
+          return pending_.load(std::memory_order_acquire) > 0;
+        });
+      }
+    }
+  }
+
+  /** Returns the pool which owns the calling thread, or nullptr. */
+  static ThreadPool* current() {
+    return current_pool();
+  }
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  Queue shared_;
+  std::vector<std::thread> threads_;
+
+  std::atomic<size_t> pending_;
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+  bool stop_;
+
+  static ThreadPool*& current_pool() {
+    static thread_local ThreadPool* pool = nullptr;
+    return pool;
+  }
+
+  static size_t& index() {
+    static thread_local size_t i = 0;
+    return i;
+  }
+
+  void work(size_t i) {
+    current_pool() = this;
+    index() = i;
+
+    std::function<void()> task;
+    while (true) {
+      if (take(i, task)) {
+        task();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      sleep_cv_.wait(lock, [this] {
+        return stop_ || pending_.load(std::memory_order_acquire) > 0;
+      });
+      if (stop_ && pending_.load(std::memory_order_acquire) == 0) {
+        return;
+      }
+    }
+  }
+
+  /** Takes a task on behalf of queue self (or of no queue if self is out of
+      range): own queue newest first, then the shared queue, then steals. */
+  bool take(size_t self, std::function<void()>& task) {
+    if (pending_.load(std::memory_order_acquire) == 0) {
+      return false;
+    }
+    if (self < queues_.size() && pop(*queues_[self], task, false)) {
+      return true;
+    }
+    if (pop(shared_, task, true)) {
+      return true;
+    }
+    for (size_t j = 1, je = queues_.size(); j <= je; ++j) {
+      if (pop(*queues_[(self + j) % je], task, true)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool pop(Queue& q, std::function<void()>& task, bool front) {
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty()) {
+      return false;
+    }
+    if (front) {
+      task = std::move(q.tasks.front());
+      q.tasks.pop_front();
+    } else {
+      task = std::move(q.tasks.back());
+      q.tasks.pop_back();
+    }
+    pending_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+};
+
+} // namespace cpputil
+
+#endif
@@ -12,39 +12,110 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#ifndef CPPUTIL_INCLUDE_LAZY_THUNK_H
+#define CPPUTIL_INCLUDE_LAZY_THUNK_H
+
+#include <atomic>
 #include <functional>
+#include <mutex>
+#include <new>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 
 #include "include/meta/indices.h"
 
 namespace cpputil {
 
+/** A lazily evaluated, memoized function application. The function is
+    invoked on first use, at most once, even if several threads use the thunk
+    at the same time. Its result is stored inline, and the function and its
+    arguments are destroyed as soon as the result is available. If the
+    function throws, the exception propagates and the next use tries again. */
 template <typename Fxn, typename... Args>
 class Thunk {
  public:
-  typedef typename std::result_of<Fxn(Args...)>::type value_type;
+  typedef typename std::decay<typename std::result_of<Fxn(Args...)>::type>::type value_type;
+
+  Thunk(Fxn&& fxn, Args&& ... args) : done_(false) {
+    new (&closure_) Closure {std::forward<Fxn>(fxn), std::tuple<Args...>(std::forward<Args>(args)...)};
+  }
+
+  /** Not thread-safe with respect to concurrent uses of rhs. */
+  Thunk(Thunk&& rhs) : done_(rhs.evaluated()) {
+    if (done_) {
+      new (&value_) value_type(std::move(rhs.value()));
+    } else {
+      new (&closure_) Closure(std::move(rhs.closure()));
+    }
+  }
 
-  Thunk(Fxn&& fxn, Args&& ... args) :
-    fxn_ {std::move(fxn)}, args_ {std::move(args)...} { }
+  Thunk(const Thunk&) = delete;
+  Thunk& operator=(const Thunk&) = delete;
 
-  operator value_type() {
-    return evaluate(MakeIndices<sizeof...(Args)>());
+  ~Thunk() {
+    if (done_) {
+      value().~value_type();
+    } else {
+      closure().~Closure();
+    }
+  }
+
+  /** Returns the result, evaluating it if this is the first use. */
+  const value_type& get() const {
+    if (!evaluated()) {
+      std::call_once(once_, [this] {
+        evaluate();
+      });
+    }
+    return value();
+  }
+
+  operator const value_type& () const {
+    return get();
+  }
+
+  bool evaluated() const {
+    return done_.load(std::memory_order_acquire);
   }
 
  private:
-  Fxn fxn_;
-  std::tuple<Args...> args_;
+  struct Closure {
+    Fxn fxn;
+    std::tuple<Args...> args;
+  };
+
+  mutable std::once_flag once_;
+  mutable std::atomic<bool> done_;
+  mutable typename std::aligned_storage<sizeof(Closure), alignof(Closure)>::type closure_;
+  mutable typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type value_;
+
+  Closure& closure() const {
+    return *reinterpret_cast<Closure*>(&closure_);
+  }
+
+  value_type& value() const {
+    return *reinterpret_cast<value_type*>(&value_);
+  }
+
+  void evaluate() const {
+    new (&value_) value_type(invoke(MakeIndices<sizeof...(Args)>()));
+    closure().~Closure();
+    done_.store(true, std::memory_order_release);
+  }
 
   template <size_t... Is>
-  value_type evaluate(Indices<Is...>) {
-    return fxn_(std::get<Is>(args_)...);
+  value_type invoke(Indices<Is...>) const {
+    auto& c = closure();
+    return c.fxn(std::get<Is>(c.args)...);
   }
 };
 
 template <typename Fxn, typename... Args>
 Thunk<Fxn, Args...> make_thunk(Fxn&& fxn, Args&& ... args) {
-  return {fxn, std::forward<Args>(args)...};
+  return {std::forward<Fxn>(fxn), std::forward<Args>(args)...};
 }
 
 } // namespace cpputil
+
+#endif
@@ -0,0 +1,352 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_MATH_COUNT_MIN_H
+#define CPPUTIL_INCLUDE_MATH_COUNT_MIN_H
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include "include/math/mix_hash.h"
+#include "include/serialize/text_reader.h"
+#include "include/serialize/text_writer.h"
+#include "include/serialize/varint.h"
+
+namespace cpputil {
+
+/** Shared layout for CountMin and CountSketch: depth rows of width counters,
+    where width is a power of two. An element's position in each row is
+    derived from a single 64-bit hash by double hashing.
+    Credit goes to: Kirsch and Mitzenmacher, Less Hashing, Same Performance */
+template <typename T, typename Hash, typename Counter>
+class FrequencySketch {
+ public:
+  size_t width() const {
+    return mask_ + 1;
+  }
+
+  size_t depth() const {
+    return depth_;
+  }
+
+  /** Returns the counters in row-major order. */
+  const std::vector<Counter>& counters() const {
+    return counters_;
+  }
+
+  void clear() {
+    std::fill(counters_.begin(), counters_.end(), 0);
+  }
+
+  /** Returns the number of heap bytes held by this sketch. */
+  size_t memory_usage() const {
+    return counters_.capacity() * sizeof(Counter);
+  }
+
+  /** Writes the width, depth and counters as varints. Since most counters
+      are small, this is typically much smaller than the in-memory layout. */
+  void write(std::ostream& os) const {
+    VarintWriter<uint64_t>()(os, width());
+    VarintWriter<uint64_t>()(os, depth());
+    for (auto c : counters_) {
+      VarintWriter<Counter>()(os, c);
+    }
+  }
+
+  /** Reads the format produced by write(). Sets failbit on malformed input,
+      in which case the sketch is left unchanged. Counters are read a block
+      at a time, so a corrupt shape fails when the input runs out rather than
+      allocating the claimed size up front. */
+  void read(std::istream& is) {
+    uint64_t w = 0;
+    uint64_t d = 0;
+    VarintReader<uint64_t>()(is, w);
+    VarintReader<uint64_t>()(is, d);
+    if (!is || !valid(w, d)) {
+      is.setstate(std::ios::failbit);
+      return;
+    }
+    std::vector<Counter> cs;
+    for (uint64_t i = 0, n = w * d; is && i < n; i += block_size()) {
+      const auto m = std::min(n - i, block_size());
+      cs.resize(i + m);
+      for (auto j = i; is && j < i + m; ++j) {
+        VarintReader<Counter>()(is, cs[j]);
+      }
+    }
+    if (is) {
+      assign(w, d, cs);
+    }
+  }
+
+ protected:
+  FrequencySketch(size_t width, size_t depth) :
+    mask_(round_up(width) - 1), depth_(std::max<size_t>(depth, 1)),
+    counters_((mask_ + 1) * depth_, 0) { }
+
+  /** Returns the row-major index of t's counter in row i given its two hashes. */
+  size_t index(uint64_t h1, uint64_t h2, size_t i) const {
+    return i * (mask_ + 1) + ((h1 + i * h2) >> 32 & mask_);
+  }
+
+  static std::pair<uint64_t, uint64_t> hashes(const T& t) {
+    const auto h = MixHash<T, Hash>()(t);
+    return std::make_pair(h, ((h >> 32) | (h << 32)) * 0x9e3779b97f4a7c15ull | 1);
+  }
+
+  /** Replaces the shape and counters of this sketch, consuming cs. Returns
+      false, leaving this sketch unchanged, if they are inconsistent. */
+  bool assign(uint64_t w, uint64_t d, std::vector<Counter>& cs) {
+    if (!valid(w, d) || cs.size() != w * d) {
+      return false;
+    }
+    mask_ = w - 1;
+    depth_ = d;
+    counters_.swap(cs);
+    return true;
+  }
+
+  /** Adds rhs's counters to this sketch's. Returns false if the shapes differ. */
+  bool add(const FrequencySketch& rhs) {
+    if (rhs.mask_ != mask_ || rhs.depth_ != depth_) {
+      return false;
+    }
+    for (size_t i = 0, ie = counters_.size(); i < ie; ++i) {
+      counters_[i] += rhs.counters_[i];
+    }
+    return true;
+  }
+
+  static constexpr uint64_t block_size() {
+    return 1 << 16;
+  }
+
+  static bool valid(uint64_t w, uint64_t d) {
+    return w > 0 && w <= (1ull << 32) && (w & (w - 1)) == 0 && d > 0 && d <= 64;
+  }
+
+  size_t mask_;
+  size_t depth_;
+  std::vector<Counter> counters_;
+
+ private:
+  static size_t round_up(size_t n) {
+    size_t res = 1;
+    for (; res < n && res < (size_t(1) << 32); res <<= 1);
+    return res;
+  }
+};
+
+/** Estimates element frequencies in a stream. Estimates never undercount;
+    with width = width_for(eps) and depth = depth_for(delta), an estimate
+    exceeds the true count by more than eps * total() with probability at
+    most delta. Conservative update (only raising the counters which are
+    at the current minimum) tightens estimates considerably for skewed
+    streams, at the price of not supporting decrements. Sketches with equal
+    shapes are merged by adding counters.
+    Credit goes to: Cormode and Muthukrishnan, An Improved Data Stream
+    Summary: The Count-Min Sketch and its Applications */
+template <typename T, typename Hash = std::hash<T>>
+class CountMin : public FrequencySketch<T, Hash, uint64_t> {
+ public:
+  CountMin(size_t width, size_t depth, bool conservative = true) :
+    FrequencySketch<T, Hash, uint64_t>(width, depth), conservative_(conservative), total_(0) { }
+
+  static size_t width_for(double eps) {
+    return std::ceil(std::exp(1.0) / eps);
+  }
+
+  static size_t depth_for(double delta) {
+    return std::ceil(std::log(1 / delta));
+  }
+
+  void push_back(const T& t, uint64_t n = 1) {
+    const auto hs = this->hashes(t);
+    total_ += n;
+    if (!conservative_) {
+      for (size_t i = 0; i < this->depth_; ++i) {
+        this->counters_[this->index(hs.first, hs.second, i)] += n;
+      }
+      return;
+    }
+
+    const auto target = estimate(hs) + n;
+    for (size_t i = 0; i < this->depth_; ++i) {
+      auto& c = this->counters_[this->index(hs.first, hs.second, i)];
+      c = std::max(c, target);
+    }
+  }
+
+  /** Returns an upper bound on the number of times t has been seen. */
+  uint64_t count(const T& t) const {
+    return estimate(this->hashes(t));
+  }
+
+  /** Returns the sum of all counts pushed so far. */
+  uint64_t total() const {
+    return total_;
+  }
+
+  /** Returns false, leaving this sketch unchanged, if the shapes differ. */
+  bool merge(const CountMin& rhs) {
+    if (!this->add(rhs)) {
+      return false;
+    }
+    total_ += rhs.total_;
+    return true;
+  }
+
+  void clear() {
+    FrequencySketch<T, Hash, uint64_t>::clear();
+    total_ = 0;
+  }
+
+  /** Writes the sketch as FrequencySketch::write() does, followed by the total. */
+  void write(std::ostream& os) const {
+    FrequencySketch<T, Hash, uint64_t>::write(os);
+    VarintWriter<uint64_t>()(os, total_);
+  }
+
+  void read(std::istream& is) {
+    CountMin tmp(1, 1, conservative_);
+    tmp.FrequencySketch<T, Hash, uint64_t>::read(is);
+    VarintReader<uint64_t>()(is, tmp.total_);
+    if (is) {
+      this->swap(tmp);
+    }
+  }
+
+  void swap(CountMin& rhs) {
+    std::swap(this->mask_, rhs.mask_);
+    std::swap(this->depth_, rhs.depth_);
+    this->counters_.swap(rhs.counters_);
+    std::swap(total_, rhs.total_);
+  }
+
+ private:
+  template <typename, typename, typename>
+  friend struct TextReader;
+
+  bool conservative_;
+  uint64_t total_;
+
+  uint64_t estimate(const std::pair<uint64_t, uint64_t>& hs) const {
+    auto res = this->counters_[this->index(hs.first, hs.second, 0)];
+    for (size_t i = 1; i < this->depth_; ++i) {
+      res = std::min(res, this->counters_[this->index(hs.first, hs.second, i)]);
+    }
+    return res;
+  }
+};
+
+/** Estimates element frequencies in a stream using signed counters. Unlike
+    CountMin, estimates are unbiased and counts may be decremented; the error
+    is bounded in terms of the stream's second moment rather than its total,
+    which is much tighter for streams without a heavy head. An odd depth is
+    recommended, as the estimate is the median across rows.
+    Credit goes to: Charikar et al, Finding Frequent Items in Data Streams */
+template <typename T, typename Hash = std::hash<T>>
+class CountSketch : public FrequencySketch<T, Hash, int64_t> {
+ public:
+  CountSketch(size_t width, size_t depth) : FrequencySketch<T, Hash, int64_t>(width, depth) { }
+
+  void push_back(const T& t, int64_t n = 1) {
+    const auto hs = this->hashes(t);
+    for (size_t i = 0; i < this->depth_; ++i) {
+      this->counters_[this->index(hs.first, hs.second, i)] += sign(hs, i) * n;
+    }
+  }
+
+  /** Returns an estimate of the number of times t has been seen. */
+  int64_t count(const T& t) const {
+    const auto hs = this->hashes(t);
+    int64_t buffer[64];
+    for (size_t i = 0; i < this->depth_; ++i) {
+      buffer[i] = sign(hs, i) * this->counters_[this->index(hs.first, hs.second, i)];
+    }
+    const auto mid = buffer + this->depth_ / 2;
+    std::nth_element(buffer, mid, buffer + this->depth_);
+    if (this->depth_ % 2 == 1) {
+      return *mid;
+    }
+    return (*std::max_element(buffer, mid) + *mid) / 2;
+  }
+
+  /** Returns false, leaving this sketch unchanged, if the shapes differ. */
+  bool merge(const CountSketch& rhs) {
+    return this->add(rhs);
+  }
+
+ private:
+  template <typename, typename, typename>
+  friend struct TextReader;
+
+  static int64_t sign(const std::pair<uint64_t, uint64_t>& hs, size_t i) {
+    return ((hs.first + i * hs.second) >> 31 & 1) ? 1 : -1;
+  }
+};
+
+/** Sketches are written as a header, { width depth } for CountSketch and
+    { width depth total } for CountMin, followed by their counters. */
+template <typename T, typename Hash, typename Style>
+struct TextWriter<CountMin<T, Hash>, Style> {
+  void operator()(std::ostream& os, const CountMin<T, Hash>& s) const {
+    const std::vector<uint64_t> header {s.width(), s.depth(), s.total()};
+    TextWriter<std::pair<std::vector<uint64_t>, std::vector<uint64_t>>, Style>()(os,
+        std::make_pair(header, s.counters()));
+  }
+};
+
+template <typename T, typename Hash, typename Style>
+struct TextReader<CountMin<T, Hash>, Style> {
+  void operator()(std::istream& is, CountMin<T, Hash>& s) const {
+    std::pair<std::vector<uint64_t>, std::vector<uint64_t>> p;
+    TextReader<decltype(p), Style>()(is, p);
+    if (!is || p.first.size() != 3 || !s.assign(p.first[0], p.first[1], p.second)) {
+      is.setstate(std::ios::failbit);
+      return;
+    }
+    s.total_ = p.first[2];
+  }
+};
+
+template <typename T, typename Hash, typename Style>
+struct TextWriter<CountSketch<T, Hash>, Style> {
+  void operator()(std::ostream& os, const CountSketch<T, Hash>& s) const {
+    const std::vector<uint64_t> header {s.width(), s.depth()};
+    TextWriter<std::pair<std::vector<uint64_t>, std::vector<int64_t>>, Style>()(os,
+        std::make_pair(header, s.counters()));
+  }
+};
+
+template <typename T, typename Hash, typename Style>
+struct TextReader<CountSketch<T, Hash>, Style> {
+  void operator()(std::istream& is, CountSketch<T, Hash>& s) const {
+    std::pair<std::vector<uint64_t>, std::vector<int64_t>> p;
+    TextReader<decltype(p), Style>()(is, p);
+    if (!is || p.first.size() != 2 || !s.assign(p.first[0], p.first[1], p.second)) {
+      is.setstate(std::ios::failbit);
+    }
+  }
+};
+
+} // namespace cpputil
+
+#endif
@@ -0,0 +1,283 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_MATH_HISTOGRAM_H
+#define CPPUTIL_INCLUDE_MATH_HISTOGRAM_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include "include/patterns/thread_shards.h"
+#include "include/serialize/text_reader.h"
+#include "include/serialize/text_writer.h"
+
+namespace cpputil {
+
+/** A log-linear histogram of non-negative integer samples, such as latencies
+    in nanoseconds. Values below 2^S are counted exactly. Above that, each
+    power of two is split into 2^(S-1) equal buckets, so every recorded value
+    is known to within a relative error of 2^(1-S). Bucket lookup is a single
+    count-leading-zeros and shift. Credit goes to: HdrHistogram. */
+template <size_t S = 8>
+class Histogram {
+ public:
+  static_assert(S >= 2 && S <= 16, "Sub-bucket bits must be between 2 and 16");
+
+  Histogram() : counts_(bucket_count(), 0) { }
+
+  /** Returns the number of buckets needed to cover every uint64_t: 2^S
+      exact buckets, plus 2^(S-1) for each of the 64-S higher powers of two. */
+  static constexpr size_t bucket_count() {
+    return (66 - S) << (S - 1);
+  }
+
+  /** Returns the bucket which holds v. */
+  static size_t index(uint64_t v) {
+    const size_t m = 64 - __builtin_clzll(v | ((1ull << S) - 1)) - S;
+    return (m << (S - 1)) + (v >> m);
+  }
+
+  /** Returns the smallest value held by bucket i. */
+  static uint64_t lower_bound(size_t i) {
+    if (i < (1ull << S)) {
+      return i;
+    }
+    const auto m = (i >> (S - 1)) - 1;
+    return (uint64_t)((i & ((1ull << (S - 1)) - 1)) | (1ull << (S - 1))) << m;
+  }
+
+  /** Returns the largest value held by bucket i. The last bucket ends at
+      UINT64_MAX, where lower_bound(i + 1) would overflow. */
+  static uint64_t upper_bound(size_t i) {
+    return i + 1 == bucket_count() ? UINT64_MAX : lower_bound(i + 1) - 1;
+  }
+
+  void record(uint64_t v, uint64_t n = 1) {
+    counts_[index(v)] += n;
+  }
+
+  void merge(const Histogram& rhs) {
+    for (size_t i = 0, ie = bucket_count(); i < ie; ++i) {
+      counts_[i] += rhs.counts_[i];
+    }
+  }
+
+  void clear() {
+    std::fill(counts_.begin(), counts_.end(), 0);
+  }
+
+  /** Returns the number of samples in bucket i. */
+  uint64_t operator[](size_t i) const {
+    return counts_[i];
+  }
+
+  uint64_t count() const {
+    uint64_t res = 0;
+    for (auto c : counts_) {
+      res += c;
+    }
+    return res;
+  }
+
+  bool empty() const {
+    return count() == 0;
+  }
+
+  /** Returns the mean, taking each sample to be at the middle of its bucket. */
+  double mean() const {
+    double sum = 0;
+    uint64_t n = 0;
+    for (size_t i = 0, ie = bucket_count(); i < ie; ++i) {
+      if (counts_[i] > 0) {
+        sum += counts_[i] * (lower_bound(i) / 2.0 + upper_bound(i) / 2.0);
+        n += counts_[i];
+      }
+    }
+    return n == 0 ? 0 : sum / n;
+  }
+
+  /** Returns the largest value which is indistinguishable from the sample
+      of rank ceil(q * count()), or 0 if the histogram is empty. Reporting
+      the top of the bucket errs on the side of overstating latencies. */
+  uint64_t quantile(double q) const {
+    const auto n = count();
+    if (n == 0) {
+      return 0;
+    }
+    q = std::min(std::max(q, 0.0), 1.0);
+    auto rank = (uint64_t)std::ceil(q * n);
+    // q * n can round up past an integer, as 0.07 * 100 does
+    if (rank > 1 && (rank - 1) / (double)n >= q) {
+      --rank;
+    }
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t so_far = 0;
+    for (size_t i = 0, ie = bucket_count(); i < ie; ++i) {
+      so_far += counts_[i];
+      if (so_far >= rank) {
+        return upper_bound(i);
+      }
+    }
+    return UINT64_MAX;
+  }
+
+  uint64_t min() const {
+    for (size_t i = 0, ie = bucket_count(); i < ie; ++i) {
+      if (counts_[i] > 0) {
+        return lower_bound(i);
+      }
+    }
+    return 0;
+  }
+
+  uint64_t max() const {
+    for (size_t i = bucket_count(); i > 0; --i) {
+      if (counts_[i - 1] > 0) {
+        return upper_bound(i - 1);
+      }
+    }
+    return 0;
+  }
+
+  /** Returns the (lower bound, count) pair of every non-empty bucket. Since
+      buckets are named by value rather than index, the result may be loaded
+      into a histogram of any precision. */
+  std::vector<std::pair<uint64_t, uint64_t>> buckets() const {
+    std::vector<std::pair<uint64_t, uint64_t>> res;
+    for (size_t i = 0, ie = bucket_count(); i < ie; ++i) {
+      if (counts_[i] > 0) {
+        res.emplace_back(lower_bound(i), counts_[i]);
+      }
+    }
+    return res;
+  }
+
+  /** Writes the non-empty buckets in a compact binary format: a 64-bit
+      bucket count followed by 64-bit (lower bound, count) pairs, all in
+      host byte order. */
+  void write(std::ostream& os) const {
+    const auto bs = buckets();
+    const uint64_t n = bs.size();
+    os.write((const char*)&n, sizeof(n));
+    for (const auto& b : bs) {
+      os.write((const char*)&b.first, sizeof(b.first));
+      os.write((const char*)&b.second, sizeof(b.second));
+    }
+  }
+
+  /** Reads the format produced by write(). Sets failbit on truncated input,
+      in which case the histogram is left cleared. */
+  void read(std::istream& is) {
+    clear();
+    uint64_t n = 0;
+    is.read((char*)&n, sizeof(n));
+    for (uint64_t i = 0; is && i < n; ++i) {
+      uint64_t v = 0;
+      uint64_t c = 0;
+      is.read((char*)&v, sizeof(v));
+      is.read((char*)&c, sizeof(c));
+      record(v, c);
+    }
+    if (!is) {
+      clear();
+    }
+  }
+
+  void swap(Histogram& rhs) {
+    counts_.swap(rhs.counts_);
+  }
+
+ private:
+  std::vector<uint64_t> counts_;
+};
+
+/** A Histogram which may be recorded into from many threads at once. Each
+    thread owns a shard of counters. Since a shard has a single writer, a
+    sample costs one relaxed load and one relaxed store (no locked
+    instruction and no cache line sharing). snapshot() sums the shards without
+    blocking writers; samples recorded concurrently may or may not be seen. */
+template <size_t S = 8>
+class ShardedHistogram {
+ public:
+  void record(uint64_t v) {
+    auto& c = shards_.local().counts[Histogram<S>::index(v)];
+    c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  Histogram<S> snapshot() const {
+    Histogram<S> res;
+    shards_.for_each([&res](const Shard & s) {
+      for (size_t i = 0, ie = Histogram<S>::bucket_count(); i < ie; ++i) {
+        const auto c = s.counts[i].load(std::memory_order_relaxed);
+        if (c > 0) {
+          res.record(Histogram<S>::lower_bound(i), c);
+        }
+      }
+    });
+    return res;
+  }
+
+ private:
+  struct Shard {
+    Shard() {
+      for (auto& c : counts) {
+        c.store(0, std::memory_order_relaxed);
+      }
+    }
+
+    std::atomic<uint64_t> counts[Histogram<S>::bucket_count()];
+  };
+
+  ThreadShards<Shard> shards_;
+};
+
+/** Histograms are written as a sequence of (lower bound, count) pairs. */
+template <size_t S, typename Style>
+struct TextWriter<Histogram<S>, Style> {
+  void operator()(std::ostream& os, const Histogram<S>& h) const {
+    TextWriter<std::vector<std::pair<uint64_t, uint64_t>>, Style>()(os, h.buckets());
+  }
+};
+
+template <size_t S, typename Style>
+struct TextReader<Histogram<S>, Style> {
+  void operator()(std::istream& is, Histogram<S>& h) const {
+    std::vector<std::pair<uint64_t, uint64_t>> bs;
+    TextReader<decltype(bs), Style>()(is, bs);
+    h.clear();
+    for (const auto& b : bs) {
+      h.record(b.first, b.second);
+    }
+  }
+};
+
+} // namespace cpputil
+
+namespace std {
+
+template <size_t S>
+void swap(cpputil::Histogram<S>& lhs, cpputil::Histogram<S>& rhs) {
+  lhs.swap(rhs);
+}
+
+} // namespace std
+
+#endif
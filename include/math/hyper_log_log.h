@@ -0,0 +1,252 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_MATH_HYPER_LOG_LOG_H
+#define CPPUTIL_INCLUDE_MATH_HYPER_LOG_LOG_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <immintrin.h>
+#include <iostream>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include "include/math/mix_hash.h"
+#include "include/serialize/text_reader.h"
+#include "include/serialize/text_writer.h"
+
+namespace cpputil {
+
+/** Estimates the number of distinct elements in a stream using 2^p one-byte
+    registers. The standard error of estimate() is about 1.04 / sqrt(2^p),
+    e.g. 0.8% in 16kB for the default p = 14, independent of the stream.
+    Sketches with equal precision are merged by a register-wise max, so
+    per-thread sketches may be combined into one.
+    Credit goes to: Flajolet et al, HyperLogLog: the analysis of a
+    near-optimal cardinality estimation algorithm */
+template <typename T, typename Hash = std::hash<T>>
+class HyperLogLog {
+ public:
+  /** Precision is clamped to [4, 18]. */
+  explicit HyperLogLog(size_t precision = 14) :
+    p_(std::min<size_t>(std::max<size_t>(precision, 4), 18)), registers_(size_t(1) << p_, 0) { }
+
+  void push_back(const T& t) {
+    push_hash(MixHash<T, Hash>()(t));
+  }
+
+  /** Records an element by its (well mixed) 64-bit hash. */
+  void push_hash(uint64_t h) {
+    const auto i = h >> (64 - p_);
+    const uint8_t rank = __builtin_clzll((h << p_) | (1ull << (p_ - 1))) + 1;
+    registers_[i] = std::max(registers_[i], rank);
+  }
+
+  /** Combines the elements seen by rhs with those seen by this sketch.
+      Returns false, leaving this sketch unchanged, if the precisions differ. */
+  bool merge(const HyperLogLog& rhs) {
+    if (rhs.p_ != p_) {
+      return false;
+    }
+    auto lhs = registers_.data();
+    const auto r = rhs.registers_.data();
+    size_t i = 0;
+#if defined(__AVX2__) && defined(__AVX__)
+    for (const auto ie = registers_.size() & ~size_t(31); i < ie; i += 32) {
+      const auto x = _mm256_loadu_si256((const __m256i*)(lhs + i));
+      const auto y = _mm256_loadu_si256((const __m256i*)(r + i));
+      _mm256_storeu_si256((__m256i*)(lhs + i), _mm256_max_epu8(x, y));
+    }
+#endif
+    for (const auto ie = registers_.size(); i < ie; ++i) {
+      lhs[i] = std::max(lhs[i], r[i]);
+    }
+    return true;
+  }
+
+  /** Returns the estimated number of distinct elements. */
+  double estimate() const {
+    const double m = registers_.size();
+    const auto sz = sums();
+    const auto e = alpha() * m * m / sz.first;
+    if (e <= 2.5 * m && sz.second > 0) {
+      return m * std::log(m / sz.second);
+    }
+    return e;
+  }
+
+  /** Returns the standard error of estimate(), relative to the true count. */
+  double relative_error() const {
+    return 1.04 / std::sqrt(double(registers_.size()));
+  }
+
+  size_t precision() const {
+    return p_;
+  }
+
+  void clear() {
+    std::fill(registers_.begin(), registers_.end(), 0);
+  }
+
+  /** Returns the number of heap bytes held by this sketch. */
+  size_t memory_usage() const {
+    return registers_.capacity();
+  }
+
+  /** Writes the precision as one byte, followed by the registers packed into
+      six bits apiece. */
+  void write(std::ostream& os) const {
+    os.put(char(p_));
+    for (size_t i = 0, ie = registers_.size(); i < ie; i += 4) {
+      const uint32_t w = registers_[i] | (registers_[i + 1] << 6) | (registers_[i + 2] << 12) |
+                         (registers_[i + 3] << 18);
+      const char bytes[3] = {char(w), char(w >> 8), char(w >> 16)};
+      os.write(bytes, 3);
+    }
+  }
+
+  /** Reads the format produced by write(). Sets failbit on malformed input,
+      in which case the sketch is left unchanged. */
+  void read(std::istream& is) {
+    const auto p = is.get();
+    if (!is || p < 4 || p > 18) {
+      is.setstate(std::ios::failbit);
+      return;
+    }
+    std::vector<uint8_t> regs(size_t(1) << p);
+    for (size_t i = 0, ie = regs.size(); i < ie; i += 4) {
+      unsigned char bytes[3];
+      if (!is.read((char*)bytes, 3)) {
+        return;
+      }
+      const uint32_t w = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16);
+      for (size_t j = 0; j < 4; ++j) {
+        regs[i + j] = (w >> (6 * j)) & 0x3f;
+      }
+    }
+    p_ = p;
+    registers_.swap(regs);
+  }
+
+  void swap(HyperLogLog& rhs) {
+    std::swap(p_, rhs.p_);
+    registers_.swap(rhs.registers_);
+  }
+
+ private:
+  template <typename, typename, typename>
+  friend struct TextWriter;
+  template <typename, typename, typename>
+  friend struct TextReader;
+
+  size_t p_;
+  std::vector<uint8_t> registers_;
+
+  double alpha() const {
+    switch (p_) {
+    case 4:
+      return 0.673;
+    case 5:
+      return 0.697;
+    case 6:
+      return 0.709;
+    default:
+      return 0.7213 / (1 + 1.079 / registers_.size());
+    }
+  }
+
+  /** Returns the sum of 2^-r over every register r, along with the number of
+      registers which are zero. */
+  std::pair<double, size_t> sums() const {
+    const auto r = registers_.data();
+    double sum = 0;
+    size_t zeros = 0;
+    size_t i = 0;
+#if defined(__AVX2__) && defined(__AVX__)
+    // 2^-r is built directly from its exponent bits, (1023 - r) << 52
+    const auto bias = _mm256_set1_epi64x(1023);
+    auto acc0 = _mm256_setzero_pd();
+    auto acc1 = _mm256_setzero_pd();
+    for (const auto ie = registers_.size() & ~size_t(31); i < ie; i += 32) {
+      const auto x = _mm256_loadu_si256((const __m256i*)(r + i));
+      zeros += __builtin_popcount(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, _mm256_setzero_si256())));
+      for (size_t j = 0; j < 32; j += 8) {
+        int lo, hi;
+        std::memcpy(&lo, r + i + j, 4);
+        std::memcpy(&hi, r + i + j + 4, 4);
+        const auto r0 = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(lo));
+        const auto r1 = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(hi));
+        acc0 = _mm256_add_pd(acc0, _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_sub_epi64(bias, r0), 52)));
+        acc1 = _mm256_add_pd(acc1, _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_sub_epi64(bias, r1), 52)));
+      }
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (const auto ie = registers_.size(); i < ie; ++i) {
+      sum += std::ldexp(1.0, -int(r[i]));
+      zeros += r[i] == 0;
+    }
+    return std::make_pair(sum, zeros);
+  }
+};
+
+/** Sketches are written as their precision followed by their registers. */
+template <typename T, typename Hash, typename Style>
+struct TextWriter<HyperLogLog<T, Hash>, Style> {
+  void operator()(std::ostream& os, const HyperLogLog<T, Hash>& h) const {
+    const std::pair<size_t, std::vector<size_t>> p(h.p_, std::vector<size_t>(h.registers_.begin(),
+        h.registers_.end()));
+    TextWriter<decltype(p), Style>()(os, p);
+  }
+};
+
+template <typename T, typename Hash, typename Style>
+struct TextReader<HyperLogLog<T, Hash>, Style> {
+  void operator()(std::istream& is, HyperLogLog<T, Hash>& h) const {
+    std::pair<size_t, std::vector<size_t>> p;
+    TextReader<decltype(p), Style>()(is, p);
+    if (!is || p.first < 4 || p.first > 18 || p.second.size() != (size_t(1) << p.first)) {
+      is.setstate(std::ios::failbit);
+      return;
+    }
+    // A register holds at most the rank of the last 64 - p hash bits
+    for (auto r : p.second) {
+      if (r > 64 - p.first + 1) {
+        is.setstate(std::ios::failbit);
+        return;
+      }
+    }
+    h.p_ = p.first;
+    h.registers_.assign(p.second.begin(), p.second.end());
+  }
+};
+
+} // namespace cpputil
+
+namespace std {
+
+template <typename T, typename Hash>
+void swap(cpputil::HyperLogLog<T, Hash>& lhs, cpputil::HyperLogLog<T, Hash>& rhs) {
+  lhs.swap(rhs);
+}
+
+} // namespace std
+
+#endif
@@ -0,0 +1,42 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_MATH_MIX_HASH_H
+#define CPPUTIL_INCLUDE_MATH_MIX_HASH_H
+
+#include <functional>
+#include <stdint.h>
+
+namespace cpputil {
+
+/** Wraps a hash function whose output may be poorly distributed (such as
+    std::hash<int>, which is the identity) so that every output bit depends
+    on every input bit. Sketches which slice hashes into fields need this.
+    Credit goes to: the MurmurHash3 64-bit finalizer. */
+template <typename T, typename Hash = std::hash<T>>
+struct MixHash {
+  uint64_t operator()(const T& t) const {
+    uint64_t h = Hash()(t);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+  }
+};
+
+} // namespace cpputil
+
+#endif
@@ -15,42 +15,350 @@
 #ifndef CPPUTIL_INCLUDE_MATH_ONLINE_STATS_H
 #define CPPUTIL_INCLUDE_MATH_ONLINE_STATS_H
 
+#include <algorithm>
+#include <cmath>
+#include <immintrin.h>
+#include <iterator>
+#include <limits>
+#include <stddef.h>
 #include <type_traits>
 
 namespace cpputil {
 
-/** Credit goes to: http://en.wikipedia.org/wiki/Algorithms_for_calculating_variance#On-line_algorithm */
+/** Tracks the size, extrema and first four central moments of a stream.
+    Integer samples are accumulated in double precision, so that the mean of
+    an integer stream is not truncated.
+    Credit goes to: http://en.wikipedia.org/wiki/Algorithms_for_calculating_variance#Higher-order_statistics */
 template <typename T, typename Enable = void>
 class OnlineStats;
 
 template <typename T>
 class OnlineStats <T, typename std::enable_if<std::is_arithmetic<T>::value>::type> {
  public:
-  OnlineStats() : n_(0), mean_(0), m2_(0) { }
+  typedef typename std::conditional<std::is_floating_point<T>::value, T, double>::type accum_type;
+
+  OnlineStats() :
+    n_(0), min_(std::numeric_limits<T>::max()), max_(std::numeric_limits<T>::lowest()),
+    mean_(0), m2_(0), m3_(0), m4_(0) { }
 
   void push_back(T t) {
-    n_++;
-    const auto delta = t - mean_;
-    mean_ += delta / n_;
-    m2_ += delta * (t - mean_);
+    const accum_type n1 = n_++;
+    const accum_type n = n_;
+    const accum_type delta = t - mean_;
+    const auto delta_n = delta / n;
+    const auto delta_n2 = delta_n * delta_n;
+    const auto term = delta * delta_n * n1;
+
+    mean_ += delta_n;
+    m4_ += term * delta_n2 * (n * n - 3 * n + 3) + 6 * delta_n2 * m2_ - 4 * delta_n * m3_;
+    m3_ += term * delta_n * (n - 2) - 3 * delta_n * m2_;
+    m2_ += term;
+    min_ = t < min_ ? t : min_;
+    max_ = t > max_ ? t : max_;
+  }
+
+  /** Pushes every sample in [first, last). For floating point types, samples
+      are processed in blocks: each block's extrema and central moments are
+      computed with independent (SIMD) sums, and the block is then folded in
+      with merge(). This removes the per-sample division and the dependency
+      between consecutive samples. Non-contiguous ranges are staged through a
+      block-sized buffer. */
+  template <typename InputIterator,
+            typename = typename std::enable_if<!std::is_arithmetic<InputIterator>::value>::type>
+  void push_back(InputIterator first, InputIterator last) {
+    typedef std::integral_constant<int, !std::is_floating_point<T>::value ? 0 :
+            std::is_same<InputIterator, T*>::value ||
+            std::is_same<InputIterator, const T*>::value ? 1 : 2> tag;
+    push_range(first, last, tag());
+  }
+
+  /** Pushes the n contiguous samples starting at data. */
+  void push_back(const T* data, size_t n) {
+    push_block(data, n, std::is_floating_point<T>());
   }
 
   size_t size() const {
     return n_;
   }
 
-  T mean() const {
+  /** Returns the smallest sample, or numeric_limits<T>::max() if empty. */
+  T min() const {
+    return min_;
+  }
+
+  /** Returns the largest sample, or numeric_limits<T>::lowest() if empty. */
+  T max() const {
+    return max_;
+  }
+
+  accum_type mean() const {
     return mean_;
   }
 
-  T variance() const {
+  /** Returns the unbiased sample variance. */
+  accum_type variance() const {
     return n_ < 2 ? 0 : m2_ / (n_ - 1);
   }
 
+  /** Returns the sample skewness, or 0 if the samples have no spread. */
+  accum_type skewness() const {
+    return m2_ == 0 ? 0 : std::sqrt(accum_type(n_)) * m3_ / std::pow(m2_, accum_type(1.5));
+  }
+
+  /** Returns the sample excess kurtosis, or 0 if the samples have no spread. */
+  accum_type kurtosis() const {
+    return m2_ == 0 ? 0 : n_ * m4_ / (m2_ * m2_) - 3;
+  }
+
+  /** Combines the samples seen by rhs with those seen by this accumulator.
+      Credit goes to: http://en.wikipedia.org/wiki/Algorithms_for_calculating_variance#Parallel_algorithm */
+  void merge(const OnlineStats& rhs) {
+    if (rhs.n_ == 0) {
+      return;
+    } else if (n_ == 0) {
+      *this = rhs;
+      return;
+    }
+
+    const accum_type na = n_;
+    const accum_type nb = rhs.n_;
+    const auto n = na + nb;
+    const auto delta = rhs.mean_ - mean_;
+    const auto delta2 = delta * delta;
+    const auto nab = na * nb / n;
+
+    mean_ += delta * nb / n;
+    m4_ += rhs.m4_ + delta2 * delta2 * nab * (na * na - na * nb + nb * nb) / (n * n) +
+           6 * delta2 * (na * na * rhs.m2_ + nb * nb * m2_) / (n * n) +
+           4 * delta * (na * rhs.m3_ - nb * m3_) / n;
+    m3_ += rhs.m3_ + delta2 * delta * nab * (na - nb) / n +
+           3 * delta * (na * rhs.m2_ - nb * m2_) / n;
+    m2_ += rhs.m2_ + delta2 * nab;
+    n_ += rhs.n_;
+    min_ = rhs.min_ < min_ ? rhs.min_ : min_;
+    max_ = rhs.max_ > max_ ? rhs.max_ : max_;
+  }
+
  private:
   size_t n_;
-  T mean_;
-  T m2_;
+  T min_;
+  T max_;
+  accum_type mean_;
+  accum_type m2_;
+  accum_type m3_;
+  accum_type m4_;
+
+  static constexpr size_t block_size() {
+    return 512;
+  }
+
+  /** Non-floating point input. */
+  template <typename InputIterator>
+  void push_range(InputIterator first, InputIterator last, std::integral_constant<int, 0>) {
+    for (; first != last; ++first) {
+      push_back(*first);
+    }
+  }
+
+  /** Contiguous floating point input. */
+  void push_range(const T* first, const T* last, std::integral_constant<int, 1>) {
+    push_block(first, last - first, std::true_type());
+  }
+
+  /** Non-contiguous floating point input. */
+  template <typename InputIterator>
+  void push_range(InputIterator first, InputIterator last, std::integral_constant<int, 2>) {
+    T buffer[block_size()];
+    while (first != last) {
+      size_t n = 0;
+      for (; n < block_size() && first != last; ++n, ++first) {
+        buffer[n] = *first;
+      }
+      push_block(buffer, n, std::true_type());
+    }
+  }
+
+  void push_block(const T* data, size_t n, std::true_type) {
+    for (size_t i = 0; i < n; i += block_size()) {
+      const auto len = n - i < block_size() ? n - i : block_size();
+      OnlineStats block;
+      block.n_ = len;
+      block.mean_ = sum(data + i, len, block.min_, block.max_) / len;
+      central_moments(data + i, len, block.mean_, block.m2_, block.m3_, block.m4_);
+      merge(block);
+    }
+  }
+
+  void push_block(const T* data, size_t n, std::false_type) {
+    for (size_t i = 0; i < n; ++i) {
+      push_back(data[i]);
+    }
+  }
+
+  /** Returns the sum of n > 0 samples and computes their extrema. Several
+      independent accumulators let the compiler vectorize and keep each
+      partial sum short. */
+  template <typename U>
+  static U sum(const U* data, size_t n, U& lo, U& hi) {
+    U acc[8] = {0};
+    lo = hi = data[0];
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+      for (size_t j = 0; j < 8; ++j) {
+        acc[j] += data[i + j];
+        lo = data[i + j] < lo ? data[i + j] : lo;
+        hi = data[i + j] > hi ? data[i + j] : hi;
+      }
+    }
+    for (; i < n; ++i) {
+      acc[0] += data[i];
+      lo = data[i] < lo ? data[i] : lo;
+      hi = data[i] > hi ? data[i] : hi;
+    }
+    return ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+  }
+
+  /** Computes the sums of the second, third and fourth powers of the
+      deviations from mean. */
+  template <typename U>
+  static void central_moments(const U* data, size_t n, U mean, U& m2, U& m3, U& m4) {
+    U a2[4] = {0};
+    U a3[4] = {0};
+    U a4[4] = {0};
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+      for (size_t j = 0; j < 4; ++j) {
+        const auto d = data[i + j] - mean;
+        const auto d2 = d * d;
+        a2[j] += d2;
+        a3[j] += d2 * d;
+        a4[j] += d2 * d2;
+      }
+    }
+    for (; i < n; ++i) {
+      const auto d = data[i] - mean;
+      const auto d2 = d * d;
+      a2[0] += d2;
+      a3[0] += d2 * d;
+      a4[0] += d2 * d2;
+    }
+    m2 = (a2[0] + a2[1]) + (a2[2] + a2[3]);
+    m3 = (a3[0] + a3[1]) + (a3[2] + a3[3]);
+    m4 = (a4[0] + a4[1]) + (a4[2] + a4[3]);
+  }
+
+#if defined(__AVX2__) && defined(__AVX__)
+  static double sum(const double* data, size_t n, double& lo, double& hi) {
+    auto acc = _mm256_setzero_pd();
+    auto vlo = _mm256_set1_pd(data[0]);
+    auto vhi = vlo;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+      const auto x = _mm256_loadu_pd(data + i);
+      acc = _mm256_add_pd(acc, x);
+      vlo = _mm256_min_pd(vlo, x);
+      vhi = _mm256_max_pd(vhi, x);
+    }
+    double res = horizontal_sum(acc);
+    double l[4], h[4];
+    _mm256_storeu_pd(l, vlo);
+    _mm256_storeu_pd(h, vhi);
+    lo = std::min(std::min(l[0], l[1]), std::min(l[2], l[3]));
+    hi = std::max(std::max(h[0], h[1]), std::max(h[2], h[3]));
+    for (; i < n; ++i) {
+      res += data[i];
+      lo = std::min(lo, data[i]);
+      hi = std::max(hi, data[i]);
+    }
+    return res;
+  }
+
+  static void central_moments(const double* data, size_t n, double mean, double& m2, double& m3,
+                              double& m4) {
+    const auto m = _mm256_set1_pd(mean);
+    auto a2 = _mm256_setzero_pd();
+    auto a3 = _mm256_setzero_pd();
+    auto a4 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+      const auto d = _mm256_sub_pd(_mm256_loadu_pd(data + i), m);
+      const auto d2 = _mm256_mul_pd(d, d);
+      a2 = _mm256_add_pd(a2, d2);
+      a3 = _mm256_add_pd(a3, _mm256_mul_pd(d2, d));
+      a4 = _mm256_add_pd(a4, _mm256_mul_pd(d2, d2));
+    }
+    m2 = horizontal_sum(a2);
+    m3 = horizontal_sum(a3);
+    m4 = horizontal_sum(a4);
+    for (; i < n; ++i) {
+      const auto d = data[i] - mean;
+      m2 += d * d;
+      m3 += d * d * d;
+      m4 += d * d * d * d;
+    }
+  }
+
+  static float sum(const float* data, size_t n, float& lo, float& hi) {
+    auto acc = _mm256_setzero_ps();
+    auto vlo = _mm256_set1_ps(data[0]);
+    auto vhi = vlo;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+      const auto x = _mm256_loadu_ps(data + i);
+      acc = _mm256_add_ps(acc, x);
+      vlo = _mm256_min_ps(vlo, x);
+      vhi = _mm256_max_ps(vhi, x);
+    }
+    float res = horizontal_sum(acc);
+    float l[8], h[8];
+    _mm256_storeu_ps(l, vlo);
+    _mm256_storeu_ps(h, vhi);
+    lo = *std::min_element(l, l + 8);
+    hi = *std::max_element(h, h + 8);
+    for (; i < n; ++i) {
+      res += data[i];
+      lo = std::min(lo, data[i]);
+      hi = std::max(hi, data[i]);
+    }
+    return res;
+  }
+
+  static void central_moments(const float* data, size_t n, float mean, float& m2, float& m3,
+                              float& m4) {
+    const auto m = _mm256_set1_ps(mean);
+    auto a2 = _mm256_setzero_ps();
+    auto a3 = _mm256_setzero_ps();
+    auto a4 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+      const auto d = _mm256_sub_ps(_mm256_loadu_ps(data + i), m);
+      const auto d2 = _mm256_mul_ps(d, d);
+      a2 = _mm256_add_ps(a2, d2);
+      a3 = _mm256_add_ps(a3, _mm256_mul_ps(d2, d));
+      a4 = _mm256_add_ps(a4, _mm256_mul_ps(d2, d2));
+    }
+    m2 = horizontal_sum(a2);
+    m3 = horizontal_sum(a3);
+    m4 = horizontal_sum(a4);
+    for (; i < n; ++i) {
+      const auto d = data[i] - mean;
+      m2 += d * d;
+      m3 += d * d * d;
+      m4 += d * d * d * d;
+    }
+  }
+
+  static double horizontal_sum(__m256d x) {
+    const auto y = _mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(y, _mm_unpackhi_pd(y, y)));
+  }
+
+  static float horizontal_sum(__m256 x) {
+    auto y = _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+    y = _mm_add_ps(y, _mm_movehl_ps(y, y));
+    return _mm_cvtss_f32(_mm_add_ss(y, _mm_shuffle_ps(y, y, 1)));
+  }
+#endif
 };
 
 } // namespace cpputil
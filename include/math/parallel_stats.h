@@ -0,0 +1,180 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_MATH_PARALLEL_STATS_H
+#define CPPUTIL_INCLUDE_MATH_PARALLEL_STATS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iterator>
+#include <stdint.h>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "include/math/online_stats.h"
+#include "include/patterns/thread_shards.h"
+
+namespace cpputil {
+
+/** Computes OnlineStats over [first, last) by splitting the range into one
+    chunk per thread, accumulating each chunk with the batched push_back(), and combining the
+    partial results in order with OnlineStats::merge(). The result agrees with
+    a sequential pass up to floating point rounding. Passing 0 uses every core. */
+template <typename RandomIt>
+OnlineStats<typename std::iterator_traits<RandomIt>::value_type>
+parallel_online_stats(RandomIt first, RandomIt last, size_t threads = 0) {
+  typedef OnlineStats<typename std::iterator_traits<RandomIt>::value_type> stats_type;
+
+  const size_t n = std::distance(first, last);
+  if (threads == 0) {
+    threads = std::thread::hardware_concurrency();
+  }
+  threads = std::max<size_t>(1, std::min<size_t>(threads, n / 4096));
+
+  std::vector<stats_type> partial(threads);
+  std::vector<std::thread> ts;
+  for (size_t i = 0; i < threads; ++i) {
+    ts.emplace_back([&partial, first, n, threads, i] {
+      partial[i].push_back(first + n * i / threads, first + n * (i + 1) / threads);
+    });
+  }
+  for (auto& t : ts) {
+    t.join();
+  }
+
+  stats_type res;
+  for (const auto& p : partial) {
+    res.merge(p);
+  }
+  return res;
+}
+
+/** An OnlineStats with a single writer whose state may be read from other
+    threads at any time. Samples are appended to a small pending buffer, and
+    every batch() samples the writer folds them into the accumulator and
+    publishes a copy of it through a sequence lock. A push between
+    publications costs two plain stores. Readers take the published
+    accumulator and the pending samples together, so every sample pushed so
+    far is seen, a reader never sees a half-updated accumulator, and the
+    writer never blocks. */
+template <typename T>
+class PublishedOnlineStats {
+ public:
+  PublishedOnlineStats() : seq_(0), pending_size_(0) {
+    publish();
+  }
+
+  /** Called only by the owning thread. */
+  void push_back(T t) {
+    const auto n = pending_size_.load(std::memory_order_relaxed);
+    pending_[n].store(t, std::memory_order_relaxed);
+    pending_size_.store(n + 1, std::memory_order_release);
+    if (n + 1 == batch()) {
+      publish();
+    }
+  }
+
+  /** May be called from any thread. */
+  OnlineStats<T> read() const {
+    uint64_t buffer[words];
+    T pending[batch()];
+    size_t n;
+    uint64_t s1, s2;
+    do {
+      s1 = seq_.load(std::memory_order_acquire);
+      for (size_t i = 0; i < words; ++i) {
+        buffer[i] = published_[i].load(std::memory_order_relaxed);
+      }
+      n = std::min(pending_size_.load(std::memory_order_acquire), batch());
+      for (size_t i = 0; i < n; ++i) {
+        pending[i] = pending_[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      s2 = seq_.load(std::memory_order_relaxed);
+    } while ((s1 & 1) || s1 != s2);
+
+    OnlineStats<T> res;
+    std::memcpy(&res, buffer, sizeof(res));
+    res.push_back(pending, pending + n);
+    return res;
+  }
+
+  /** The number of samples between publications. */
+  static constexpr size_t batch() {
+    return 32;
+  }
+
+ private:
+  static_assert(std::is_trivially_copyable<OnlineStats<T>>::value,
+                "OnlineStats must be trivially copyable to be published");
+
+  static constexpr size_t words = (sizeof(OnlineStats<T>) + 7) / 8;
+
+  OnlineStats<T> stats_;
+  std::atomic<uint64_t> seq_;
+  std::atomic<uint64_t> published_[words];
+  std::atomic<size_t> pending_size_;
+  std::atomic<T> pending_[batch()];
+
+  /** Folds the pending samples into the accumulator and publishes it. */
+  void publish() {
+    const auto s = seq_.load(std::memory_order_relaxed);
+    seq_.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    T pending[batch()];
+    const auto n = pending_size_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < n; ++i) {
+      pending[i] = pending_[i].load(std::memory_order_relaxed);
+    }
+    stats_.push_back(pending, pending + n);
+
+    uint64_t buffer[words] = {0};
+    std::memcpy(buffer, &stats_, sizeof(stats_));
+    for (size_t i = 0; i < words; ++i) {
+      published_[i].store(buffer[i], std::memory_order_relaxed);
+    }
+    pending_size_.store(0, std::memory_order_relaxed);
+    seq_.store(s + 2, std::memory_order_release);
+  }
+};
+
+/** An OnlineStats which may be fed from many threads at once. Each thread
+    accumulates into its own PublishedOnlineStats without contention;
+    aggregate() merges the shards without blocking writers. */
+template <typename T>
+class ShardedOnlineStats {
+ public:
+  void push_back(T t) {
+    shards_.local().push_back(t);
+  }
+
+  /** Returns the merge of every thread's samples seen so far. */
+  OnlineStats<T> aggregate() const {
+    OnlineStats<T> res;
+    shards_.for_each([&res](const PublishedOnlineStats<T>& s) {
+      res.merge(s.read());
+    });
+    return res;
+  }
+
+ private:
+  ThreadShards<PublishedOnlineStats<T>> shards_;
+};
+
+} // namespace cpputil
+
+#endif
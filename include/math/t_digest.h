@@ -0,0 +1,314 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_MATH_T_DIGEST_H
+#define CPPUTIL_INCLUDE_MATH_T_DIGEST_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stddef.h>
+#include <type_traits>
+#include <vector>
+
+namespace cpputil {
+
+/** A mergeable sketch of the distribution of an unbounded stream, answering
+    quantile and cdf queries in bounded memory.
+
+    Samples are clustered into weighted centroids. The arcsine scale function
+    keeps centroids near the median large and those near either tail small,
+    so extreme quantiles (p99, p999) are far more accurate than the median.
+    The compression parameter delta trades memory for accuracy:
+      - at most delta centroids are retained, plus a buffer of 4 * delta
+        unmerged samples and a 5 * delta scratch area for merging them (16
+        bytes each), so memory is about 160 * delta bytes.
+      - a centroid covering quantile q spans at most 2 * pi * sqrt(q(1-q)) / delta
+        of the rank space, so the rank error at q is bounded by about half of
+        that (see rank_error_bound()). In practice it is several times smaller.
+
+    Credit goes to: Dunning and Ertl, Computing Extremely Accurate Quantiles
+    Using t-Digests. */
+template <typename T, typename Enable = void>
+class TDigest;
+
+template <typename T>
+class TDigest <T, typename std::enable_if<std::is_arithmetic<T>::value>::type> {
+ public:
+  explicit TDigest(double compression = 100) :
+    compression_(compression), n_(0),
+    min_(std::numeric_limits<double>::infinity()), max_(-std::numeric_limits<double>::infinity()) {
+    buffer_.reserve(buffer_size());
+  }
+
+  /** Returns a compression which keeps the rank error at every quantile
+      below eps. */
+  static double compression_for(double eps) {
+    return std::ceil(pi() * 0.5 / eps);
+  }
+
+  /** Returns the worst case rank error at quantile q for a given compression. */
+  static double rank_error_bound(double q, double compression) {
+    return pi() * std::sqrt(q * (1 - q)) / compression;
+  }
+
+  void push_back(T t) {
+    push_centroid(Centroid(t, 1));
+  }
+
+  /** Pushes every sample in [first, last). Samples are appended to the
+      buffer, which is sorted and merged once per 4 * delta samples. */
+  template <typename InputIterator,
+            typename = typename std::enable_if<!std::is_arithmetic<InputIterator>::value>::type>
+  void push_back(InputIterator first, InputIterator last) {
+    for (; first != last; ++first) {
+      push_back(*first);
+    }
+  }
+
+  /** Pushes the n contiguous samples starting at data. */
+  void push_back(const T* data, size_t n) {
+    while (n > 0) {
+      const auto len = std::min(n, buffer_size() - buffer_.size());
+      const auto mm = std::minmax_element(data, data + len);
+      min_ = std::min(min_, static_cast<double>(*mm.first));
+      max_ = std::max(max_, static_cast<double>(*mm.second));
+      for (size_t i = 0; i < len; ++i) {
+        buffer_.push_back(Centroid(data[i], 1));
+      }
+      n_ += len;
+      data += len;
+      n -= len;
+      if (buffer_.size() >= buffer_size()) {
+        flush();
+      }
+    }
+  }
+
+  /** Combines the samples seen by rhs with those seen by this sketch. The
+      result respects this sketch's compression. */
+  void merge(const TDigest& rhs) {
+    if (&rhs == this) {
+      const TDigest copy(rhs);
+      merge(copy);
+      return;
+    }
+    for (const auto& c : rhs.centroids_) {
+      push_centroid(c);
+    }
+    for (const auto& c : rhs.buffer_) {
+      push_centroid(c);
+    }
+    // Centroid means lie inside the data, so take the extrema from rhs
+    min_ = std::min(min_, rhs.min_);
+    max_ = std::max(max_, rhs.max_);
+  }
+
+  size_t size() const {
+    return n_;
+  }
+
+  bool empty() const {
+    return n_ == 0;
+  }
+
+  double compression() const {
+    return compression_;
+  }
+
+  double min() const {
+    return min_;
+  }
+
+  double max() const {
+    return max_;
+  }
+
+  /** Returns the number of centroids after all buffered samples are merged. */
+  size_t centroids() const {
+    flush();
+    return centroids_.size();
+  }
+
+  /** Returns an estimate of the value below which a fraction q of the
+      samples lie. Returns NaN if no samples have been seen. */
+  double quantile(double q) const {
+    flush();
+    if (centroids_.empty()) {
+      return std::numeric_limits<double>::quiet_NaN();
+    } else if (centroids_.size() == 1) {
+      return centroids_[0].mean;
+    }
+
+    const auto index = std::min(std::max(q, 0.0), 1.0) * n_;
+    const auto& first = centroids_.front();
+    if (index < first.weight / 2) {
+      return interpolate(min_, first.mean, index / (first.weight / 2));
+    }
+
+    auto so_far = first.weight / 2;
+    for (size_t i = 0, ie = centroids_.size() - 1; i < ie; ++i) {
+      const auto dw = (centroids_[i].weight + centroids_[i + 1].weight) / 2;
+      if (so_far + dw > index) {
+        return interpolate(centroids_[i].mean, centroids_[i + 1].mean, (index - so_far) / dw);
+      }
+      so_far += dw;
+    }
+
+    const auto& last = centroids_.back();
+    return interpolate(last.mean, max_, std::min((index - so_far) / (last.weight / 2), 1.0));
+  }
+
+  /** Returns an estimate of the fraction of samples which are at most x.
+      Returns NaN if no samples have been seen. */
+  double cdf(double x) const {
+    flush();
+    if (centroids_.empty()) {
+      return std::numeric_limits<double>::quiet_NaN();
+    } else if (x < min_) {
+      return 0;
+    } else if (x >= max_) {
+      return 1;
+    }
+
+    const auto& first = centroids_.front();
+    if (x < first.mean) {
+      return first.weight / 2 * (x - min_) / (first.mean - min_) / n_;
+    }
+
+    auto so_far = first.weight / 2;
+    for (size_t i = 0, ie = centroids_.size() - 1; i < ie; ++i) {
+      const auto dw = (centroids_[i].weight + centroids_[i + 1].weight) / 2;
+      if (x < centroids_[i + 1].mean) {
+        return (so_far + dw * (x - centroids_[i].mean) /
+                (centroids_[i + 1].mean - centroids_[i].mean)) / n_;
+      }
+      so_far += dw;
+    }
+
+    const auto& last = centroids_.back();
+    return (so_far + last.weight / 2 * (x - last.mean) / (max_ - last.mean)) / n_;
+  }
+
+  /** Returns the number of heap bytes held by this sketch. */
+  size_t memory_usage() const {
+    return (centroids_.capacity() + buffer_.capacity() + scratch_.capacity()) * sizeof(Centroid);
+  }
+
+  void swap(TDigest& rhs) {
+    std::swap(compression_, rhs.compression_);
+    std::swap(n_, rhs.n_);
+    std::swap(min_, rhs.min_);
+    std::swap(max_, rhs.max_);
+    centroids_.swap(rhs.centroids_);
+    buffer_.swap(rhs.buffer_);
+    scratch_.swap(rhs.scratch_);
+  }
+
+ private:
+  struct Centroid {
+    Centroid() = default;
+    Centroid(double m, double w) : mean(m), weight(w) { }
+
+    bool operator<(const Centroid& rhs) const {
+      return mean < rhs.mean;
+    }
+
+    double mean;
+    double weight;
+  };
+
+  double compression_;
+  size_t n_;
+  double min_;
+  double max_;
+
+  // Queries are logically const, but merge any buffered samples first
+  mutable std::vector<Centroid> centroids_;
+  mutable std::vector<Centroid> buffer_;
+  mutable std::vector<Centroid> scratch_;
+
+  size_t buffer_size() const {
+    return 4 * static_cast<size_t>(std::ceil(compression_));
+  }
+
+  void push_centroid(const Centroid& c) {
+    n_ += c.weight;
+    min_ = std::min(min_, c.mean);
+    max_ = std::max(max_, c.mean);
+    buffer_.push_back(c);
+    if (buffer_.size() >= buffer_size()) {
+      flush();
+    }
+  }
+
+  static double interpolate(double lo, double hi, double f) {
+    return lo + (hi - lo) * f;
+  }
+
+  static constexpr double pi() {
+    return 3.14159265358979323846;
+  }
+
+  /** The arcsine scale function and its inverse. */
+  double k(double q) const {
+    return compression_ / (2 * pi()) * std::asin(2 * q - 1);
+  }
+  double k_inv(double k) const {
+    return (std::sin(std::min(std::max(k * 2 * pi() / compression_, -pi() / 2), pi() / 2)) + 1) / 2;
+  }
+
+  /** Sorts the buffer into the existing centroids and recompresses. */
+  void flush() const {
+    if (buffer_.empty()) {
+      return;
+    }
+
+    std::sort(buffer_.begin(), buffer_.end());
+    scratch_.resize(centroids_.size() + buffer_.size());
+    std::merge(centroids_.begin(), centroids_.end(), buffer_.begin(), buffer_.end(), scratch_.begin());
+    buffer_.clear();
+    centroids_.clear();
+
+    const double total = n_;
+    auto so_far = 0.0;
+    auto limit = total * k_inv(k(0) + 1);
+    centroids_.push_back(scratch_[0]);
+    for (size_t i = 1, ie = scratch_.size(); i < ie; ++i) {
+      auto& back = centroids_.back();
+      const auto& next = scratch_[i];
+      if (so_far + back.weight + next.weight <= limit) {
+        back.weight += next.weight;
+        back.mean += (next.mean - back.mean) * next.weight / back.weight;
+      } else {
+        so_far += back.weight;
+        limit = total * k_inv(k(so_far / total) + 1);
+        centroids_.push_back(next);
+      }
+    }
+  }
+};
+
+} // namespace cpputil
+
+namespace std {
+
+template <typename T>
+void swap(cpputil::TDigest<T>& lhs, cpputil::TDigest<T>& rhs) {
+  lhs.swap(rhs);
+}
+
+} // namespace std
+
+#endif
@@ -0,0 +1,183 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_MATH_WINDOWED_STATS_H
+#define CPPUTIL_INCLUDE_MATH_WINDOWED_STATS_H
+
+#include <deque>
+#include <stddef.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cpputil {
+
+/** Exponentially weighted mean and variance. Each sample is weighted by
+    alpha, and the weight of every earlier sample decays by (1 - alpha).
+    Credit goes to: Finch, Incremental calculation of weighted mean and variance */
+template <typename T, typename Enable = void>
+class EwmaStats;
+
+template <typename T>
+class EwmaStats <T, typename std::enable_if<std::is_arithmetic<T>::value>::type> {
+ public:
+  typedef typename std::conditional<std::is_floating_point<T>::value, T, double>::type accum_type;
+
+  explicit EwmaStats(accum_type alpha) : alpha_(alpha), n_(0), mean_(0), variance_(0) { }
+
+  void push_back(T t) {
+    if (n_++ == 0) {
+      mean_ = t;
+      return;
+    }
+    const accum_type delta = t - mean_;
+    const auto incr = alpha_ * delta;
+    mean_ += incr;
+    variance_ = (1 - alpha_) * (variance_ + delta * incr);
+  }
+
+  size_t size() const {
+    return n_;
+  }
+
+  accum_type alpha() const {
+    return alpha_;
+  }
+
+  accum_type mean() const {
+    return mean_;
+  }
+
+  accum_type variance() const {
+    return variance_;
+  }
+
+ private:
+  accum_type alpha_;
+  size_t n_;
+  accum_type mean_;
+  accum_type variance_;
+};
+
+/** Size, mean, variance and extrema of the most recent window() samples.
+    Samples are kept in a ring buffer, and moments are updated by adding the
+    new sample and removing the evicted one. To keep rounding error from
+    accumulating, the moments are recomputed from the buffer once per pass
+    around the ring, which is still O(1) amortized. Extrema are tracked with
+    monotonic queues (each sample is pushed and popped at most once).
+    Credit goes to: Lemire, Streaming Maximum-Minimum Filter Using No More than
+    Three Comparisons per Element */
+template <typename T, typename Enable = void>
+class WindowedStats;
+
+template <typename T>
+class WindowedStats <T, typename std::enable_if<std::is_arithmetic<T>::value>::type> {
+ public:
+  typedef typename std::conditional<std::is_floating_point<T>::value, T, double>::type accum_type;
+
+  /** Window must be positive. */
+  explicit WindowedStats(size_t window) :
+    ring_(window), head_(0), n_(0), pushed_(0), mean_(0), m2_(0) { }
+
+  void push_back(T t) {
+    if (n_ < ring_.size()) {
+      n_++;
+      const accum_type delta = t - mean_;
+      mean_ += delta / n_;
+      m2_ += delta * (t - mean_);
+    } else {
+      const accum_type old = ring_[head_];
+      const auto old_mean = mean_;
+      mean_ += (t - old) / n_;
+      m2_ += (t - old) * (t - mean_ + old - old_mean);
+    }
+    ring_[head_] = t;
+    if (++head_ == ring_.size()) {
+      head_ = 0;
+      recompute();
+    }
+
+    while (!mins_.empty() && mins_.back().second >= t) {
+      mins_.pop_back();
+    }
+    mins_.emplace_back(pushed_, t);
+    while (!maxs_.empty() && maxs_.back().second <= t) {
+      maxs_.pop_back();
+    }
+    maxs_.emplace_back(pushed_, t);
+    pushed_++;
+    evict(mins_);
+    evict(maxs_);
+  }
+
+  /** Returns the number of samples in the window. */
+  size_t size() const {
+    return n_;
+  }
+
+  size_t window() const {
+    return ring_.size();
+  }
+
+  /** Returns the smallest sample in the window. Undefined if empty. */
+  T min() const {
+    return mins_.front().second;
+  }
+
+  /** Returns the largest sample in the window. Undefined if empty. */
+  T max() const {
+    return maxs_.front().second;
+  }
+
+  accum_type mean() const {
+    return mean_;
+  }
+
+  accum_type variance() const {
+    return n_ < 2 ? 0 : (m2_ < 0 ? 0 : m2_) / (n_ - 1);
+  }
+
+ private:
+  std::vector<T> ring_;
+  size_t head_;
+  size_t n_;
+  size_t pushed_;
+  accum_type mean_;
+  accum_type m2_;
+  /** (sample number, value) pairs with increasing (resp. decreasing) values */
+  std::deque<std::pair<size_t, T>> mins_;
+  std::deque<std::pair<size_t, T>> maxs_;
+
+  void evict(std::deque<std::pair<size_t, T>>& q) {
+    while (q.front().first + ring_.size() < pushed_) {
+      q.pop_front();
+    }
+  }
+
+  void recompute() {
+    accum_type sum = 0;
+    for (auto x : ring_) {
+      sum += x;
+    }
+    mean_ = sum / n_;
+    m2_ = 0;
+    for (auto x : ring_) {
+      m2_ += (x - mean_) * (x - mean_);
+    }
+  }
+};
+
+} // namespace cpputil
+
+#endif
@@ -18,6 +18,9 @@
 #include <unordered_set>
 #include <utility>
 
+#include "include/container/hash_stats.h"
+#include "include/memory/memory_usage.h"
+
 namespace cpputil {
 
 template <typename T, typename Set = std::unordered_set<T>>
@@ -61,6 +64,17 @@ class Interner {
     vals_.clear();
   }
 
+  /** Total bytes used by this interner, including the heap memory owned by
+      the interned values themselves. */
+  size_t memory_usage() const {
+    return sizeof(*this) + MemoryUsage<Set>()(vals_);
+  }
+
+  /** Hash statistics for the underlying set. */
+  HashStats hash_stats() const {
+    return HashProfiler<Set>()(vals_);
+  }
+
   void swap(Interner& rhs) {
     vals_.swap(rhs.vals_);
   }
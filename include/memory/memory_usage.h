@@ -0,0 +1,210 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_MEMORY_MEMORY_USAGE_H
+#define CPPUTIL_INCLUDE_MEMORY_MEMORY_USAGE_H
+
+#include <deque>
+#include <list>
+#include <map>
+#include <set>
+#include <stddef.h>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace cpputil {
+
+/** Returns the number of bytes consumed by a heap allocation of n bytes,
+    including the allocator's chunk header and rounding slack. This models
+    glibc malloc: an 8-byte header, 16-byte granularity and 32-byte minimum. */
+inline size_t malloc_size(size_t n) {
+  if (n == 0) {
+    return 0;
+  }
+  const size_t chunk = (n + sizeof(size_t) + 15) & ~size_t(15);
+  return chunk < 32 ? 32 : chunk;
+}
+
+/** Estimates the heap memory owned by a value, not counting sizeof(T) itself.
+    Node layouts follow libstdc++. Types with a memory_usage() member (which
+    reports the total, including sizeof(T)) are handled generically. Types
+    which are not recognized are assumed to own no heap memory. */
+template <typename T, typename Enable = void>
+struct MemoryUsage {
+  size_t operator()(const T&) const {
+    return 0;
+  }
+};
+
+template <typename T>
+struct has_memory_usage {
+ private:
+  template <typename U>
+  static auto test(int) -> decltype(std::declval<const U&>().memory_usage(), std::true_type());
+  template <typename U>
+  static std::false_type test(...);
+
+ public:
+  static constexpr bool value = decltype(test<T>(0))::value;
+};
+
+/** Sums the heap memory owned by the elements of a range. Skipped entirely
+    for element types which never own heap memory. */
+template <typename T, typename Itr>
+size_t element_memory_usage(Itr begin, Itr end) {
+  if (std::is_arithmetic<T>::value || std::is_pointer<T>::value || std::is_enum<T>::value) {
+    return 0;
+  }
+  size_t res = 0;
+  for (; begin != end; ++begin) {
+    res += MemoryUsage<T>()(*begin);
+  }
+  return res;
+}
+
+template <typename T>
+struct MemoryUsage<T, typename std::enable_if<has_memory_usage<T>::value>::type> {
+  size_t operator()(const T& t) const {
+    return t.memory_usage() - sizeof(T);
+  }
+};
+
+template <typename C, typename Tr, typename A>
+struct MemoryUsage<std::basic_string<C, Tr, A>> {
+  size_t operator()(const std::basic_string<C, Tr, A>& s) const {
+    // Short strings live inside the object itself.
+    const auto p = (const char*) s.data();
+    if (p >= (const char*) &s && p < (const char*)(&s + 1)) {
+      return 0;
+    }
+    return malloc_size((s.capacity() + 1) * sizeof(C));
+  }
+};
+
+template <typename T1, typename T2>
+struct MemoryUsage<std::pair<T1, T2>> {
+  size_t operator()(const std::pair<T1, T2>& p) const {
+    return MemoryUsage<typename std::remove_const<T1>::type>()(p.first) +
+           MemoryUsage<typename std::remove_const<T2>::type>()(p.second);
+  }
+};
+
+template <typename T, typename A>
+struct MemoryUsage<std::vector<T, A>> {
+  size_t operator()(const std::vector<T, A>& v) const {
+    return malloc_size(v.capacity() * sizeof(T)) + element_memory_usage<T>(v.begin(), v.end());
+  }
+};
+
+template <typename T, typename A>
+struct MemoryUsage<std::deque<T, A>> {
+  size_t operator()(const std::deque<T, A>& d) const {
+    // 512-byte blocks plus a map of block pointers.
+    const size_t per_block = sizeof(T) < 512 ? 512 / sizeof(T) : 1;
+    const size_t blocks = d.size() / per_block + 1;
+    return blocks * malloc_size(per_block * sizeof(T)) + malloc_size((blocks + 2) * sizeof(void*)) +
+           element_memory_usage<T>(d.begin(), d.end());
+  }
+};
+
+template <typename T, typename A>
+struct MemoryUsage<std::list<T, A>> {
+  size_t operator()(const std::list<T, A>& l) const {
+    return l.size() * malloc_size(2 * sizeof(void*) + sizeof(T)) +
+           element_memory_usage<T>(l.begin(), l.end());
+  }
+};
+
+/** Red-black tree nodes carry a color and three pointers. */
+template <typename C>
+size_t tree_memory_usage(const C& c) {
+  typedef typename C::value_type value_type;
+  return c.size() * malloc_size(4 * sizeof(void*) + sizeof(value_type)) +
+         element_memory_usage<value_type>(c.begin(), c.end());
+}
+
+template <typename K, typename T, typename C, typename A>
+struct MemoryUsage<std::map<K, T, C, A>> {
+  size_t operator()(const std::map<K, T, C, A>& m) const {
+    return tree_memory_usage(m);
+  }
+};
+
+template <typename K, typename T, typename C, typename A>
+struct MemoryUsage<std::multimap<K, T, C, A>> {
+  size_t operator()(const std::multimap<K, T, C, A>& m) const {
+    return tree_memory_usage(m);
+  }
+};
+
+template <typename K, typename C, typename A>
+struct MemoryUsage<std::set<K, C, A>> {
+  size_t operator()(const std::set<K, C, A>& s) const {
+    return tree_memory_usage(s);
+  }
+};
+
+template <typename K, typename C, typename A>
+struct MemoryUsage<std::multiset<K, C, A>> {
+  size_t operator()(const std::multiset<K, C, A>& s) const {
+    return tree_memory_usage(s);
+  }
+};
+
+/** Hash table nodes carry a next pointer and, unless the key is arithmetic,
+    a cached hash code. Buckets are an array of pointers. */
+template <typename C>
+size_t hash_memory_usage(const C& c) {
+  typedef typename C::value_type value_type;
+  const size_t cached = std::is_arithmetic<typename C::key_type>::value ? 0 : sizeof(size_t);
+  const size_t buckets = c.bucket_count() > 1 ? malloc_size(c.bucket_count() * sizeof(void*)) : 0;
+  return buckets + c.size() * malloc_size(sizeof(void*) + sizeof(value_type) + cached) +
+         element_memory_usage<value_type>(c.begin(), c.end());
+}
+
+template <typename K, typename T, typename H, typename E, typename A>
+struct MemoryUsage<std::unordered_map<K, T, H, E, A>> {
+  size_t operator()(const std::unordered_map<K, T, H, E, A>& m) const {
+    return hash_memory_usage(m);
+  }
+};
+
+template <typename K, typename T, typename H, typename E, typename A>
+struct MemoryUsage<std::unordered_multimap<K, T, H, E, A>> {
+  size_t operator()(const std::unordered_multimap<K, T, H, E, A>& m) const {
+    return hash_memory_usage(m);
+  }
+};
+
+template <typename K, typename H, typename E, typename A>
+struct MemoryUsage<std::unordered_set<K, H, E, A>> {
+  size_t operator()(const std::unordered_set<K, H, E, A>& s) const {
+    return hash_memory_usage(s);
+  }
+};
+
+template <typename K, typename H, typename E, typename A>
+struct MemoryUsage<std::unordered_multiset<K, H, E, A>> {
+  size_t operator()(const std::unordered_multiset<K, H, E, A>& s) const {
+    return hash_memory_usage(s);
+  }
+};
+
+} // namespace cpputil
+
+#endif
@@ -0,0 +1,37 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_META_HAS_RESERVE_H
+#define CPPUTIL_INCLUDE_META_HAS_RESERVE_H
+
+#include <cstddef>
+#include <type_traits>
+
+namespace cpputil {
+
+template <typename T>
+struct has_reserve {
+ private:
+  template <typename U>
+  static auto test(int) -> decltype(std::declval<U&>().reserve(size_t(0)), std::true_type());
+  template <typename U>
+  static std::false_type test(...);
+
+ public:
+  static constexpr bool value = decltype(test<T>(0))::value;
+};
+
+} // namespace cpputil
+
+#endif
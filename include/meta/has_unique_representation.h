@@ -0,0 +1,41 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_META_HAS_UNIQUE_REPRESENTATION_H
+#define CPPUTIL_INCLUDE_META_HAS_UNIQUE_REPRESENTATION_H
+
+#include <array>
+#include <type_traits>
+
+namespace cpputil {
+
+/** True for types whose every byte belongs to their value, so that copying
+    their raw bytes is deterministic. These are the arithmetic types and
+    arrays of them. long double is excluded because it is padded on x86, and
+    so are structs, since C++11 cannot tell whether they are padded. */
+template <typename T>
+struct has_unique_representation : public std::integral_constant < bool,
+    std::is_arithmetic<T>::value && !std::is_same<typename std::remove_cv<T>::type, long double>::value > { };
+
+template <typename T, size_t N>
+struct has_unique_representation<std::array<T, N>> : public std::integral_constant < bool,
+    has_unique_representation<T>::value && sizeof(std::array<T, N>) == N * sizeof(T) > { };
+
+template <typename T, size_t N>
+struct has_unique_representation<const std::array<T, N>> : public
+    has_unique_representation<std::array<T, N>> { };
+
+} // namespace cpputil
+
+#endif
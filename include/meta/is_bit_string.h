@@ -0,0 +1,40 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_META_IS_BIT_STRING_H
+#define CPPUTIL_INCLUDE_META_IS_BIT_STRING_H
+
+#include <type_traits>
+
+namespace cpputil {
+
+template <typename T>
+class BitString;
+
+/** True for BitString and the classes derived from it (BitVector and
+    BitArray). */
+template <typename T>
+struct is_bit_string {
+ private:
+  template <typename C>
+  static std::true_type test(const BitString<C>*);
+  static std::false_type test(...);
+
+ public:
+  static constexpr bool value = decltype(test(std::declval<T*>()))::value;
+};
+
+} // namespace cpputil
+
+#endif
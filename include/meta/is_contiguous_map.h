@@ -0,0 +1,39 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_META_IS_CONTIGUOUS_MAP_H
+#define CPPUTIL_INCLUDE_META_IS_CONTIGUOUS_MAP_H
+
+#include <type_traits>
+
+namespace cpputil {
+
+/** True for maps that store their keys and values in contiguous arrays and
+    expose them through key_data() and value_data(). */
+template <typename T>
+struct is_contiguous_map {
+ private:
+  template <typename U>
+  static auto test(int) -> decltype(std::declval<const U&>().key_data(),
+                                    std::declval<const U&>().value_data(), std::true_type());
+  template <typename U>
+  static std::false_type test(...);
+
+ public:
+  static constexpr bool value = decltype(test<T>(0))::value;
+};
+
+} // namespace cpputil
+
+#endif
@@ -0,0 +1,58 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_META_IS_REFLECTED_H
+#define CPPUTIL_INCLUDE_META_IS_REFLECTED_H
+
+#include <tuple>
+#include <type_traits>
+
+/** Declares the fields of a struct, in serialization order. Place it in the
+    struct body after the fields it names:
+
+      struct Point {
+        int x;
+        int y;
+        CPPUTIL_REFLECT(x, y)
+      };
+
+    This adds a pair of cpputil_fields() members that return a std::tie() of
+    the fields, which the serializers unpack at compile time. The fields are
+    reached through references, so nothing is copied and every access
+    inlines. */
+#define CPPUTIL_REFLECT(...) \
+  auto cpputil_fields() -> decltype(std::tie(__VA_ARGS__)) { \
+    return std::tie(__VA_ARGS__); \
+  } \
+  auto cpputil_fields() const -> decltype(std::tie(__VA_ARGS__)) { \
+    return std::tie(__VA_ARGS__); \
+  }
+
+namespace cpputil {
+
+template <typename T>
+struct is_reflected {
+ private:
+  template <typename U>
+  static auto test(int) -> decltype(std::declval<U&>().cpputil_fields(), std::true_type());
+  template <typename U>
+  static std::false_type test(...);
+
+ public:
+  static constexpr bool value = decltype(test<T>(0))::value;
+};
+
+} // namespace cpputil
+
+#endif
@@ -0,0 +1,118 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_PATTERNS_THREAD_SHARDS_H
+#define CPPUTIL_INCLUDE_PATTERNS_THREAD_SHARDS_H
+
+#include <atomic>
+#include <stdint.h>
+#include <thread>
+
+namespace cpputil {
+
+/** Hands each thread its own default-constructed instance of S. Shards are
+    kept on a lock-free list: a thread's first call to local() pushes a new
+    shard with a compare-and-swap, and later calls hit a small thread-local
+    cache keyed by instance, so a thread which alternates between a few
+    ThreadShards<S> keeps hitting it.
+    Shards outlive the threads that created them and are freed along with
+    this object. Readers walking the shards with for_each() must synchronize
+    with writers through S itself (e.g. by making its fields atomic). */
+template <typename S>
+class ThreadShards {
+ public:
+  ThreadShards() : head_(nullptr), id_(next_id()) { }
+  ThreadShards(const ThreadShards&) = delete;
+  ThreadShards& operator=(const ThreadShards&) = delete;
+
+  ~ThreadShards() {
+    for (auto n = head_.load(std::memory_order_acquire); n != nullptr;) {
+      const auto next = n->next;
+      delete n;
+      n = next;
+    }
+  }
+
+  /** Returns the calling thread's shard, creating it if necessary. */
+  S& local() {
+    // Direct mapped: consecutively created instances use different entries
+    static thread_local Cache cache[cache_size()];
+    auto& c = cache[id_ % cache_size()];
+    if (c.id == id_) {
+      return c.node->shard;
+    }
+
+    const auto tid = std::this_thread::get_id();
+    auto n = head_.load(std::memory_order_acquire);
+    for (; n != nullptr && n->tid != tid; n = n->next);
+    if (n == nullptr) {
+      n = new Node(tid);
+      n->next = head_.load(std::memory_order_relaxed);
+      while (!head_.compare_exchange_weak(n->next, n, std::memory_order_release,
+                                          std::memory_order_relaxed));
+    }
+
+    c.id = id_;
+    c.node = n;
+    return n->shard;
+  }
+
+  /** Invokes f on every shard created so far. */
+  template <typename Fxn>
+  void for_each(Fxn f) const {
+    for (auto n = head_.load(std::memory_order_acquire); n != nullptr; n = n->next) {
+      f(const_cast<const S&>(n->shard));
+    }
+  }
+
+  /** Invokes f on every shard created so far. */
+  template <typename Fxn>
+  void for_each(Fxn f) {
+    for (auto n = head_.load(std::memory_order_acquire); n != nullptr; n = n->next) {
+      f(n->shard);
+    }
+  }
+
+ private:
+  struct Node {
+    Node(std::thread::id t) : tid(t), next(nullptr) { }
+
+    S shard;
+    std::thread::id tid;
+    Node* next;
+  };
+
+  struct Cache {
+    uint64_t id;
+    Node* node;
+  };
+
+  static constexpr size_t cache_size() {
+    return 8;
+  }
+
+  std::atomic<Node*> head_;
+  /** Distinguishes instances in the thread-local cache, even across reuse of
+      the same address. */
+  const uint64_t id_;
+
+  static uint64_t next_id() {
+    static std::atomic<uint64_t> id(0);
+    return ++id;
+  }
+};
+
+} // namespace cpputil
+
+#endif
@@ -0,0 +1,46 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_SERIALIZE_BINARY_KEY_INDEX_H
+#define CPPUTIL_INCLUDE_SERIALIZE_BINARY_KEY_INDEX_H
+
+#include <type_traits>
+
+#include "include/meta/has_unique_representation.h"
+
+namespace cpputil {
+
+/** True for sets and maps which BinaryWriter writes with a key index: sorted
+    containers whose keys are not written raw. Their keys are preceded by
+    size() + 1 raw uint64_t offsets, one for each key and one past the last,
+    relative to the first key. The index lets BinaryView binary search keys of
+    varying length and jump straight past them to a map's values. Sorted
+    containers of raw keys need no index, and unordered containers are only
+    ever scanned. */
+template <typename T>
+struct has_binary_key_index {
+ private:
+  template <typename U>
+  static auto test(int) -> decltype(typename U::key_compare(), std::integral_constant < bool,
+                                    !has_unique_representation<typename U::key_type>::value > ());
+  template <typename U>
+  static std::false_type test(...);
+
+ public:
+  static constexpr bool value = decltype(test<T>(0))::value;
+};
+
+} // namespace cpputil
+
+#endif
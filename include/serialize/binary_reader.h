@@ -0,0 +1,346 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_SERIALIZE_BINARY_READER_H
+#define CPPUTIL_INCLUDE_SERIALIZE_BINARY_READER_H
+
+#include <algorithm>
+#include <array>
+#include <stdint.h>
+#include <iostream>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "include/io/stream_access.h"
+#include "include/meta/has_reserve.h"
+#include "include/meta/has_unique_representation.h"
+#include "include/meta/is_contiguous_sequence.h"
+#include "include/meta/is_reflected.h"
+#include "include/meta/is_stl_map.h"
+#include "include/meta/is_stl_pair.h"
+#include "include/meta/is_stl_sequence.h"
+#include "include/meta/is_stl_set.h"
+#include "include/meta/is_stl_string.h"
+#include "include/meta/is_stl_tuple.h"
+#include "include/serialize/binary_key_index.h"
+#include "include/serialize/varint.h"
+
+namespace cpputil {
+
+/** Every serialized element occupies at least one byte, so whatever a stream
+    has buffered bounds what is worth reserving for a length prefix. */
+inline size_t binary_avail(std::istream& is) {
+  const auto avail = is.rdbuf()->in_avail();
+  return avail > 0 ? size_t(avail) : 0;
+}
+
+/** Reads the format produced by BinaryWriter. Sets failbit on truncated
+    input. Length prefixes are trusted only as far as the input backs them:
+    bulk reads grow their destination a block at a time, so a corrupt length
+    fails rather than allocating the whole claimed size up front. */
+template <typename T, typename Enable = void>
+struct BinaryReader;
+
+#define fail_unless(c) \
+	if (!(c)) { \
+		is.setstate(std::ios::failbit | std::ios::eofbit); \
+		return; \
+	}
+
+/** Reads one element of a container. */
+template <typename T, typename Enable = void>
+struct BinaryElementReader {
+  void operator()(std::istream& is, T& t) const {
+    BinaryReader<T>()(is, t);
+  }
+};
+
+template <typename T>
+struct BinaryElementReader<T, typename std::enable_if<has_unique_representation<T>::value>::type> {
+  void operator()(std::istream& is, T& t) const {
+    fail_unless(StreamAccess::get(is.rdbuf(), (char*)&t, sizeof(T)) == sizeof(T));
+  }
+};
+
+template <typename T>
+struct BinaryReader < T, typename std::enable_if < std::is_integral<T>::value &&
+    (sizeof(T) > 1) >::type > {
+  void operator()(std::istream& is, T& t) const {
+    VarintReader<T>()(is, t);
+  }
+};
+
+template <typename T>
+struct BinaryReader < T, typename std::enable_if < std::is_floating_point<T>::value ||
+    (std::is_integral<T>::value && sizeof(T) == 1) >::type > {
+  void operator()(std::istream& is, T& t) const {
+    fail_unless(StreamAccess::get(is.rdbuf(), (char*)&t, sizeof(T)) == sizeof(T));
+  }
+};
+
+template <typename T>
+struct BinaryReader<T, typename std::enable_if<is_stl_string<T>::value>::type> {
+  void operator()(std::istream& is, T& t) const {
+    size_t n = 0;
+    VarintReader<size_t>()(is, n);
+
+    // Strings which are already buffered are copied out in one step
+    auto sb = is.rdbuf();
+    const auto begin = StreamAccess::get_begin(sb);
+    if (is && size_t(StreamAccess::get_end(sb) - begin) >= n) {
+      t.assign(begin, n);
+      StreamAccess::get_consume(sb, begin + n);
+      return;
+    }
+
+    t.clear();
+    for (size_t i = 0; is && i < n; i += block_size()) {
+      const auto m = std::min(n - i, block_size());
+      t.resize(i + m);
+      fail_unless(size_t(StreamAccess::get(is.rdbuf(), &t[i], m)) == m);
+    }
+  }
+
+ private:
+  static constexpr size_t block_size() {
+    return 1 << 20;
+  }
+};
+
+template <typename T>
+struct BinaryReader<T, typename std::enable_if <is_stl_pair<T>::value>::type> {
+  void operator()(std::istream& is, T& t) const {
+    BinaryReader<typename T::first_type>()(is, t.first);
+    BinaryReader<typename T::second_type>()(is, t.second);
+  }
+};
+
+template <typename T>
+class BinaryReader < T, typename std::enable_if < is_contiguous_sequence<T>::value &&
+    has_unique_representation<typename T::value_type>::value >::type > {
+ public:
+  void operator()(std::istream& is, T& t) const {
+    size_t n = 0;
+    VarintReader<size_t>()(is, n);
+    if (is) {
+      read(is, t, n);
+    }
+  }
+
+ private:
+  typedef typename T::value_type value_type;
+
+  static constexpr size_t block_size() {
+    return ((1 << 20) + sizeof(value_type) - 1) / sizeof(value_type);
+  }
+
+  template <size_t N>
+  static void read(std::istream& is, std::array<value_type, N>& t, size_t n) {
+    fail_unless(n == N);
+    const auto bytes = N * sizeof(value_type);
+    fail_unless(size_t(StreamAccess::get(is.rdbuf(), (char*)t.data(), bytes)) == bytes);
+  }
+
+  template <typename S>
+  static void read(std::istream& is, S& t, size_t n) {
+    t.clear();
+    for (size_t i = 0; i < n; i += block_size()) {
+      const auto m = std::min(n - i, block_size());
+      t.resize(i + m);
+      const auto bytes = m * sizeof(value_type);
+      fail_unless(size_t(StreamAccess::get(is.rdbuf(), (char*)(t.data() + i), bytes)) == bytes);
+    }
+  }
+};
+
+template <typename T>
+class BinaryReader < T, typename std::enable_if < is_stl_sequence<T>::value &&
+    !(is_contiguous_sequence<T>::value &&
+      has_unique_representation<typename T::value_type>::value) >::type > {
+ public:
+  void operator()(std::istream& is, T& t) const {
+    size_t n = 0;
+    VarintReader<size_t>()(is, n);
+    if (is) {
+      read(is, t, n);
+    }
+  }
+
+ private:
+  typedef typename T::value_type value_type;
+
+  template <size_t N>
+  static void read(std::istream& is, std::array<value_type, N>& t, size_t n) {
+    fail_unless(n == N);
+    for (auto& elem : t) {
+      BinaryElementReader<value_type>()(is, elem);
+    }
+  }
+
+  template <typename S>
+  static typename std::enable_if<has_reserve<S>::value, void>::type
+  reserve(std::istream& is, S& t, size_t n) {
+    t.reserve(std::min(n, binary_avail(is)));
+  }
+
+  template <typename S>
+  static typename std::enable_if<!has_reserve<S>::value, void>::type
+  reserve(std::istream&, S&, size_t) { }
+
+  template <typename S>
+  static void read(std::istream& is, S& t, size_t n) {
+    t.clear();
+    reserve(is, t, n);
+    for (size_t i = 0; is && i < n; ++i) {
+      read_back(is, t);
+    }
+  }
+
+  /** Reads an element in place at the back of t, dropping it again if it is
+      truncated. */
+  template <typename S>
+  static typename std::enable_if<std::is_same<typename S::reference, value_type&>::value, void>::type
+  read_back(std::istream& is, S& t) {
+    t.emplace_back();
+    BinaryElementReader<value_type>()(is, t.back());
+    if (!is) {
+      t.pop_back();
+    }
+  }
+
+  /** Containers of proxies, such as std::vector<bool>, read into a copy. */
+  template <typename S>
+  static typename std::enable_if < !std::is_same<typename S::reference, value_type&>::value, void >::type
+  read_back(std::istream& is, S& t) {
+    value_type v = value_type();
+    BinaryElementReader<value_type>()(is, v);
+    if (is) {
+      t.emplace_back(std::move(v));
+    }
+  }
+};
+
+/** Skips the key index of a set or map with n keys, if it has one. Readers
+    rebuild the container, so they have no use for it. */
+template <typename T>
+typename std::enable_if < !has_binary_key_index<T>::value, void >::type
+skip_binary_key_index(std::istream&, size_t) { }
+
+template <typename T>
+typename std::enable_if<has_binary_key_index<T>::value, void>::type
+skip_binary_key_index(std::istream& is, size_t n) {
+  for (size_t i = 0; is && i <= n; ++i) {
+    uint64_t offset;
+    fail_unless(StreamAccess::get(is.rdbuf(), (char*)&offset, sizeof(offset)) == sizeof(offset));
+  }
+}
+
+template <typename T>
+struct BinaryReader<T, typename std::enable_if<is_stl_set<T>::value>::type> {
+  void operator()(std::istream& is, T& t) const {
+    size_t n = 0;
+    VarintReader<size_t>()(is, n);
+    skip_binary_key_index<T>(is, n);
+
+    t.clear();
+    for (size_t i = 0; is && i < n; ++i) {
+      typename T::key_type k = typename T::key_type();
+      BinaryElementReader<decltype(k)>()(is, k);
+      if (is) {
+        t.emplace_hint(t.end(), std::move(k));
+      }
+    }
+  }
+};
+
+template <typename T>
+struct BinaryReader<T, typename std::enable_if<is_stl_map<T>::value>::type> {
+  void operator()(std::istream& is, T& t) const {
+    size_t n = 0;
+    VarintReader<size_t>()(is, n);
+    skip_binary_key_index<T>(is, n);
+
+    // Keys come first, so they are held until their values arrive
+    std::vector<typename T::key_type> keys;
+    keys.reserve(std::min(n, binary_avail(is)));
+    for (size_t i = 0; is && i < n; ++i) {
+      keys.emplace_back();
+      BinaryElementReader<typename T::key_type>()(is, keys.back());
+    }
+
+    t.clear();
+    for (size_t i = 0; is && i < n; ++i) {
+      typename T::mapped_type v = typename T::mapped_type();
+      BinaryElementReader<decltype(v)>()(is, v);
+      if (is) {
+        t.emplace_hint(t.end(), std::move(keys[i]), std::move(v));
+      }
+    }
+  }
+};
+
+template <typename T>
+class BinaryReader <T, typename std::enable_if <is_stl_tuple<T>::value>::type> {
+ public:
+  void operator()(std::istream& is, T& t) const {
+    Helper<T, 0, std::tuple_size<T>::value>()(is, t);
+  }
+
+ private:
+  template <typename Tuple, size_t Begin, size_t End>
+  struct Helper {
+    void operator()(std::istream& is, Tuple& t) {
+      BinaryReader<typename std::tuple_element<Begin, Tuple>::type>()(is, std::get<Begin>(t));
+      Helper < Tuple, Begin + 1, End > ()(is, t);
+    }
+  };
+
+  template <typename Tuple, size_t End>
+  struct Helper<Tuple, End, End> {
+    void operator()(std::istream&, Tuple&) { }
+  };
+};
+
+/** Reflected structs are read field by field, like tuples. */
+template <typename T>
+class BinaryReader <T, typename std::enable_if <is_reflected<T>::value>::type> {
+ public:
+  void operator()(std::istream& is, T& t) const {
+    auto fields = t.cpputil_fields();
+    typedef decltype(fields) Tuple;
+    Helper<Tuple, 0, std::tuple_size<Tuple>::value>()(is, fields);
+  }
+
+ private:
+  template <typename Tuple, size_t Begin, size_t End>
+  struct Helper {
+    void operator()(std::istream& is, Tuple& t) {
+      typedef typename std::tuple_element<Begin, Tuple>::type Field;
+      BinaryReader<typename std::decay<Field>::type>()(is, std::get<Begin>(t));
+      Helper < Tuple, Begin + 1, End > ()(is, t);
+    }
+  };
+
+  template <typename Tuple, size_t End>
+  struct Helper<Tuple, End, End> {
+    void operator()(std::istream&, Tuple&) { }
+  };
+};
+
+#undef fail_unless
+
+} // namespace cpputil
+
+#endif
@@ -0,0 +1,708 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_SERIALIZE_BINARY_VIEW_H
+#define CPPUTIL_INCLUDE_SERIALIZE_BINARY_VIEW_H
+
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "include/meta/has_unique_representation.h"
+#include "include/meta/is_stl_map.h"
+#include "include/meta/is_stl_pair.h"
+#include "include/meta/is_stl_sequence.h"
+#include "include/meta/is_stl_set.h"
+#include "include/meta/is_stl_string.h"
+#include "include/meta/is_stl_tuple.h"
+#include "include/serialize/binary_key_index.h"
+#include "include/serialize/binary_writer.h"
+#include "include/system/mapped_file.h"
+
+namespace cpputil {
+
+/** A read-only view of a value in the format produced by BinaryWriter, over
+    bytes held elsewhere (typically a MappedFile). Constructing a view only
+    records where its bytes begin and where the enclosing buffer ends;
+    nothing is parsed, copied or allocated until an accessor is called.
+    Bounds are checked lazily as well: next() returns the address just past
+    a value, or nullptr if the value would run off the end of the buffer, and
+    accessors of a truncated value return defaults rather than reading out of
+    bounds. Nothing in the format is aligned, so raw values are read with
+    memcpy. */
+template <typename T, typename Enable = void>
+class BinaryView;
+
+/** Storage and decoding shared by every view. */
+class BinaryViewBase {
+ public:
+  BinaryViewBase() : begin_(nullptr), end_(nullptr) { }
+  BinaryViewBase(const char* begin, const char* end) : begin_(begin), end_(end) { }
+
+  /** Returns the address of the first byte of this value. */
+  const char* data() const {
+    return begin_;
+  }
+
+ protected:
+  const char* begin_;
+  const char* end_;
+
+  /** Decodes a varint at p. Returns the address past it or nullptr. */
+  template <typename U>
+  static const char* decode(const char* p, const char* end, U& u) {
+    typedef typename std::make_unsigned<U>::type V;
+    V v = 0;
+    for (size_t shift = 0; p != nullptr && p < end && shift < sizeof(U) * 8; shift += 7) {
+      const auto c = (unsigned char) * p++;
+      v |= V(c & 0x7f) << shift;
+      if ((c & 0x80) == 0) {
+        u = std::is_signed<U>::value ? U((v >> 1) ^ (V(0) - (v & 1))) : U(v);
+        return p;
+      }
+    }
+    return nullptr;
+  }
+
+  /** Reads a raw value at p, or returns a default if it is out of bounds. */
+  template <typename U>
+  static U load(const char* p, const char* end) {
+    U u = U();
+    if (p != nullptr && size_t(end - p) >= sizeof(U)) {
+      memcpy((void*)&u, p, sizeof(U));
+    }
+    return u;
+  }
+
+  /** Returns p advanced by n bytes, or nullptr if that passes end. */
+  static const char* advance(const char* p, const char* end, size_t n) {
+    return p != nullptr && size_t(end - p) >= n ? p + n : nullptr;
+  }
+};
+
+template <typename T>
+class BinaryView < T, typename std::enable_if < std::is_integral<T>::value &&
+    (sizeof(T) > 1) >::type > : public BinaryViewBase {
+ public:
+  BinaryView() : BinaryViewBase() { }
+  BinaryView(const char* begin, const char* end) : BinaryViewBase(begin, end) { }
+
+  T get() const {
+    T t = T();
+    decode(begin_, end_, t);
+    return t;
+  }
+  operator T() const {
+    return get();
+  }
+
+  const char* next() const {
+    T t;
+    return decode(begin_, end_, t);
+  }
+  bool valid() const {
+    return next() != nullptr;
+  }
+};
+
+template <typename T>
+class BinaryView < T, typename std::enable_if < std::is_floating_point<T>::value ||
+    (std::is_integral<T>::value && sizeof(T) == 1) >::type > : public BinaryViewBase {
+ public:
+  BinaryView() : BinaryViewBase() { }
+  BinaryView(const char* begin, const char* end) : BinaryViewBase(begin, end) { }
+
+  T get() const {
+    return load<T>(begin_, end_);
+  }
+  operator T() const {
+    return get();
+  }
+
+  const char* next() const {
+    return advance(begin_, end_, sizeof(T));
+  }
+  bool valid() const {
+    return next() != nullptr;
+  }
+};
+
+template <typename T>
+class BinaryView<T, typename std::enable_if<is_stl_string<T>::value>::type> :
+  public BinaryViewBase {
+ public:
+  BinaryView() : BinaryViewBase() { }
+  BinaryView(const char* begin, const char* end) : BinaryViewBase(begin, end) { }
+
+  /** The characters of the string, or nullptr if it is truncated. They are
+      not null terminated. */
+  const char* c_data() const {
+    size_t n = 0;
+    return valid_body(n);
+  }
+  size_t size() const {
+    size_t n = 0;
+    return valid_body(n) != nullptr ? n : 0;
+  }
+  bool empty() const {
+    return size() == 0;
+  }
+  /** Returns the i'th character, or '\0' if the string is truncated. */
+  char operator[](size_t i) const {
+    const auto p = c_data();
+    return p != nullptr ? p[i] : '\0';
+  }
+  /** A truncated string is an empty range. */
+  const char* begin() const {
+    const auto p = c_data();
+    return p != nullptr ? p : end_;
+  }
+  const char* end() const {
+    size_t n = 0;
+    const auto p = valid_body(n);
+    return p != nullptr ? p + n : end_;
+  }
+
+  /** Copies the string out of the view. */
+  std::string str() const {
+    size_t n = 0;
+    const auto p = valid_body(n);
+    return p != nullptr ? std::string(p, n) : std::string();
+  }
+  operator std::string() const {
+    return str();
+  }
+
+  /** Compares with s in the manner of std::string::compare(). */
+  int compare(const char* s, size_t len) const {
+    size_t n = 0;
+    const auto p = valid_body(n);
+    const auto res = n == 0 || len == 0 ? 0 : memcmp(p, s, std::min(n, len));
+    return res != 0 ? res : n < len ? -1 : n > len ? 1 : 0;
+  }
+  int compare(const std::string& s) const {
+    return compare(s.data(), s.size());
+  }
+  bool operator==(const std::string& s) const {
+    return compare(s) == 0;
+  }
+  bool operator!=(const std::string& s) const {
+    return compare(s) != 0;
+  }
+  bool operator<(const std::string& s) const {
+    return compare(s) < 0;
+  }
+
+  const char* next() const {
+    size_t n = 0;
+    const auto p = valid_body(n);
+    return p != nullptr ? p + n : nullptr;
+  }
+  bool valid() const {
+    return next() != nullptr;
+  }
+
+ private:
+  /** Returns the first character and sets n to the length, or returns
+      nullptr and sets n to zero if the string runs out of bounds. */
+  const char* valid_body(size_t& n) const {
+    const auto p = decode(begin_, end_, n);
+    if (advance(p, end_, n) == nullptr) {
+      n = 0;
+      return nullptr;
+    }
+    return p;
+  }
+};
+
+/** How a view presents the elements of a container. Elements with a unique
+    representation are stored raw at a fixed stride and are returned by value.
+    Everything else is returned as a view and found by walking from the
+    first element. */
+template <typename T, typename Enable = void>
+struct BinaryElementView {
+  typedef BinaryView<T> type;
+
+  static type get(const char* p, const char* end) {
+    return p != nullptr ? type(p, end) : type(end, end);
+  }
+  static const char* skip(const char* p, const char* end, size_t n) {
+    for (size_t i = 0; p != nullptr && i < n; ++i) {
+      p = type(p, end).next();
+    }
+    return p;
+  }
+  static constexpr bool random_access() {
+    return false;
+  }
+};
+
+template <typename T>
+struct BinaryElementView<T, typename std::enable_if<has_unique_representation<T>::value>::type> :
+  private BinaryViewBase {
+  typedef T type;
+
+  static type get(const char* p, const char* end) {
+    return load<T>(p, end);
+  }
+  static const char* skip(const char* p, const char* end, size_t n) {
+    return n <= size_t(-1) / sizeof(T) ? advance(p, end, n * sizeof(T)) : nullptr;
+  }
+  static constexpr bool random_access() {
+    return true;
+  }
+};
+
+/** Iterates over n consecutive elements of a container. */
+template <typename T>
+class BinaryElementIterator {
+ public:
+  typedef std::forward_iterator_tag iterator_category;
+  typedef typename BinaryElementView<T>::type value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef void pointer;
+  typedef value_type reference;
+
+  BinaryElementIterator() : p_(nullptr), end_(nullptr), n_(0) { }
+  BinaryElementIterator(const char* p, const char* end, size_t n) : p_(p), end_(end), n_(n) { }
+
+  value_type operator*() const {
+    return BinaryElementView<T>::get(p_, end_);
+  }
+  BinaryElementIterator& operator++() {
+    p_ = BinaryElementView<T>::skip(p_, end_, 1);
+    --n_;
+    return *this;
+  }
+  BinaryElementIterator operator++(int) {
+    const auto res = *this;
+    ++(*this);
+    return res;
+  }
+  bool operator==(const BinaryElementIterator& rhs) const {
+    return n_ == rhs.n_;
+  }
+  bool operator!=(const BinaryElementIterator& rhs) const {
+    return !(*this == rhs);
+  }
+
+ private:
+  const char* p_;
+  const char* end_;
+  size_t n_;
+};
+
+template <typename T>
+class BinaryView<T, typename std::enable_if<is_stl_pair<T>::value>::type> :
+  public BinaryViewBase {
+ public:
+  typedef typename std::remove_const<typename T::first_type>::type first_type;
+  typedef typename std::remove_const<typename T::second_type>::type second_type;
+
+  BinaryView() : BinaryViewBase() { }
+  BinaryView(const char* begin, const char* end) : BinaryViewBase(begin, end) { }
+
+  BinaryView<first_type> first() const {
+    return BinaryView<first_type>(begin_, end_);
+  }
+  BinaryView<second_type> second() const {
+    const auto p = first().next();
+    return BinaryView<second_type>(p != nullptr ? p : end_, end_);
+  }
+
+  const char* next() const {
+    return first().next() != nullptr ? second().next() : nullptr;
+  }
+  bool valid() const {
+    return next() != nullptr;
+  }
+};
+
+template <typename T>
+class BinaryView<T, typename std::enable_if<is_stl_tuple<T>::value>::type> :
+  public BinaryViewBase {
+ public:
+  BinaryView() : BinaryViewBase() { }
+  BinaryView(const char* begin, const char* end) : BinaryViewBase(begin, end) { }
+
+  /** Returns a view of the I'th element. Finding it walks the elements
+      before it. */
+  template <size_t I>
+  BinaryView<typename std::tuple_element<I, T>::type> get() const {
+    const auto p = Offset<I>::of(begin_, end_);
+    return BinaryView<typename std::tuple_element<I, T>::type>(p != nullptr ? p : end_, end_);
+  }
+
+  const char* next() const {
+    return Offset<std::tuple_size<T>::value>::of(begin_, end_);
+  }
+  bool valid() const {
+    return next() != nullptr;
+  }
+
+ private:
+  template <size_t I, typename Dummy = void>
+  struct Offset {
+    static const char* of(const char* begin, const char* end) {
+      const auto p = Offset < I - 1 >::of(begin, end);
+      return p != nullptr ? BinaryView<typename std::tuple_element < I - 1, T >::type>(p, end).next() :
+             nullptr;
+    }
+  };
+
+  template <typename Dummy>
+  struct Offset<0, Dummy> {
+    static const char* of(const char* begin, const char*) {
+      return begin;
+    }
+  };
+};
+
+template <typename T>
+class BinaryView<T, typename std::enable_if<is_stl_sequence<T>::value>::type> :
+  public BinaryViewBase {
+ public:
+  typedef typename BinaryElementView<typename T::value_type>::type value_type;
+  typedef BinaryElementIterator<typename T::value_type> const_iterator;
+
+  BinaryView() : BinaryViewBase() { }
+  BinaryView(const char* begin, const char* end) : BinaryViewBase(begin, end) { }
+
+  size_t size() const {
+    size_t n = 0;
+    decode(begin_, end_, n);
+    return n;
+  }
+  bool empty() const {
+    return size() == 0;
+  }
+
+  /** Returns the i'th element. Constant time for raw elements, linear
+      otherwise. */
+  value_type operator[](size_t i) const {
+    return Elem::get(Elem::skip(first(), end_, i), end_);
+  }
+
+  const_iterator begin() const {
+    return const_iterator(first(), end_, size());
+  }
+  const_iterator end() const {
+    return const_iterator(nullptr, end_, 0);
+  }
+
+  const char* next() const {
+    return Elem::skip(first(), end_, size());
+  }
+  bool valid() const {
+    return next() != nullptr;
+  }
+
+ private:
+  typedef BinaryElementView<typename T::value_type> Elem;
+
+  const char* first() const {
+    size_t n = 0;
+    return decode(begin_, end_, n);
+  }
+};
+
+/** Views of sets and maps share lookup. Keys of sorted containers are found
+    by binary search, either over the raw key array or through the key index
+    (see has_binary_key_index). Keys of unordered containers are found by a
+    linear scan. */
+template <typename T>
+class BinaryAssociativeView : public BinaryViewBase {
+ public:
+  typedef typename T::key_type key_type;
+  typedef typename BinaryElementView<key_type>::type key_view;
+
+  BinaryAssociativeView() : BinaryViewBase() { }
+  BinaryAssociativeView(const char* begin, const char* end) : BinaryViewBase(begin, end) { }
+
+  size_t size() const {
+    size_t n = 0;
+    decode(begin_, end_, n);
+    return n;
+  }
+  bool empty() const {
+    return size() == 0;
+  }
+
+  /** Returns the i'th key. Constant time for raw or indexed keys, linear
+      otherwise. */
+  key_view key(size_t i) const {
+    return Key::get(key_data(i), end_);
+  }
+
+  /** Returns the index of a key equal to k, or size() if there is none. */
+  size_t find(const key_type& k) const {
+    return find(k, 0);
+  }
+  bool contains(const key_type& k) const {
+    return find(k) != size();
+  }
+
+ protected:
+  typedef BinaryElementView<key_type> Key;
+
+  /** Returns the address of the first key. */
+  const char* keys() const {
+    size_t n = 0;
+    const auto p = decode(begin_, end_, n);
+    if (!has_binary_key_index<T>::value) {
+      return p;
+    }
+    return n < size_t(-1) / sizeof(uint64_t) ? advance(p, end_, (n + 1) * sizeof(uint64_t)) : nullptr;
+  }
+
+  /** Returns the address of the i'th key, or of the end of the keys if i is
+      size(). */
+  const char* key_data(size_t i) const {
+    const auto p = keys();
+    if (!has_binary_key_index<T>::value) {
+      return Key::skip(p, end_, i);
+    } else if (p == nullptr || i > size()) {
+      return nullptr;
+    }
+    // The index lies in bounds if the first key does
+    const auto offset = load<uint64_t>(p - (size() + 1 - i) * sizeof(uint64_t), p);
+    return offset <= size_t(-1) ? advance(p, end_, size_t(offset)) : nullptr;
+  }
+
+ private:
+  template <typename U>
+  static constexpr bool sorted(decltype(typename U::key_compare())*) {
+    return BinaryElementView<typename U::key_type>::random_access() ||
+           has_binary_key_index<U>::value;
+  }
+  template <typename U>
+  static constexpr bool sorted(...) {
+    return false;
+  }
+
+  /** Compares a key view with a key. String views are compared in place
+      rather than copied out. */
+  template <typename Comp, typename A, typename B>
+  static bool less(const Comp& comp, const A& a, const B& b) {
+    return comp(a, b);
+  }
+  static bool less(const std::less<std::string>&, const BinaryView<std::string>& v,
+                   const std::string& k) {
+    return v.compare(k) < 0;
+  }
+  static bool less(const std::less<std::string>&, const std::string& k,
+                   const BinaryView<std::string>& v) {
+    return v.compare(k) > 0;
+  }
+
+  template <typename U = T>
+  typename std::enable_if<sorted<U>(0), size_t>::type find(const key_type& k, int) const {
+    const auto comp = typename U::key_compare();
+    size_t lo = 0;
+    size_t hi = size();
+    while (lo < hi) {
+      const auto mid = lo + (hi - lo) / 2;
+      if (less(comp, key(mid), k)) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo < size() && !less(comp, k, key(lo)) ? lo : size();
+  }
+
+  template <typename U = T>
+  typename std::enable_if < !sorted<U>(0), size_t >::type find(const key_type& k, int) const {
+    const auto n = size();
+    auto p = keys();
+    for (size_t i = 0; i < n && p != nullptr; ++i, p = Key::skip(p, end_, 1)) {
+      if (Key::get(p, end_) == k) {
+        return i;
+      }
+    }
+    return n;
+  }
+};
+
+template <typename T>
+class BinaryView<T, typename std::enable_if<is_stl_set<T>::value>::type> :
+  public BinaryAssociativeView<T> {
+ public:
+  typedef typename BinaryAssociativeView<T>::key_view value_type;
+  typedef BinaryElementIterator<typename T::key_type> const_iterator;
+
+  BinaryView() : BinaryAssociativeView<T>() { }
+  BinaryView(const char* begin, const char* end) : BinaryAssociativeView<T>(begin, end) { }
+
+  const_iterator begin() const {
+    return const_iterator(this->keys(), this->end_, this->size());
+  }
+  const_iterator end() const {
+    return const_iterator(nullptr, this->end_, 0);
+  }
+
+  const char* next() const {
+    return this->key_data(this->size());
+  }
+  bool valid() const {
+    return next() != nullptr;
+  }
+};
+
+template <typename T>
+class BinaryView<T, typename std::enable_if<is_stl_map<T>::value>::type> :
+  public BinaryAssociativeView<T> {
+ public:
+  typedef typename T::mapped_type mapped_type;
+  typedef typename BinaryElementView<mapped_type>::type mapped_view;
+
+  BinaryView() : BinaryAssociativeView<T>() { }
+  BinaryView(const char* begin, const char* end) : BinaryAssociativeView<T>(begin, end) { }
+
+  /** Returns the value mapped to the i'th key. */
+  mapped_view value(size_t i) const {
+    return Mapped::get(Mapped::skip(values(), this->end_, i), this->end_);
+  }
+
+  /** Returns the value mapped to k, or a default if there is none. */
+  mapped_view at(const typename T::key_type& k) const {
+    const auto i = this->find(k);
+    return i != this->size() ? value(i) : Mapped::get(this->end_, this->end_);
+  }
+
+  const char* next() const {
+    return Mapped::skip(values(), this->end_, this->size());
+  }
+  bool valid() const {
+    return next() != nullptr;
+  }
+
+ private:
+  typedef BinaryElementView<mapped_type> Mapped;
+
+  const char* values() const {
+    return this->key_data(this->size());
+  }
+};
+
+/** A file holding one value in the BinaryWriter format behind a fixed size
+    header: a magic number, the length of the payload and a checksum of it.
+    Opening a file maps it and checks the magic number and length, which
+    takes constant time; the checksum is only computed if verify() is
+    called. */
+template <typename T>
+class BinaryFile {
+ public:
+  /** Writes t to os with a header. */
+  static void write(std::ostream& os, const T& t) {
+    std::stringstream ss;
+    BinaryWriter<T>()(ss, t);
+    const auto payload = ss.str();
+
+    const uint64_t header[3] = {magic(), payload.size(), checksum(payload.data(), payload.size())};
+    os.rdbuf()->sputn((const char*)header, sizeof(header));
+    os.rdbuf()->sputn(payload.data(), payload.size());
+  }
+
+  BinaryFile() : verified_(unknown) { }
+  explicit BinaryFile(const std::string& path) : BinaryFile() {
+    open(path);
+  }
+
+  /** Maps path. Returns false if it cannot be mapped or does not start with
+      a header which matches its length. */
+  bool open(const std::string& path) {
+    verified_ = unknown;
+    if (!file_.open(path) || file_.size() < header_size() ||
+        load(0) != magic() || load(1) != file_.size() - header_size()) {
+      file_.close();
+      return false;
+    }
+    return true;
+  }
+  bool is_open() const {
+    return file_.is_open();
+  }
+
+  /** Returns a view of the value. */
+  BinaryView<T> view() const {
+    return is_open() ? BinaryView<T>(file_.begin() + header_size(), file_.end()) : BinaryView<T>();
+  }
+
+  /** Returns true if the payload matches its checksum. The result is
+      computed on the first call and remembered. */
+  bool verify() const {
+    if (verified_ == unknown && is_open()) {
+      const auto p = file_.begin() + header_size();
+      verified_ = checksum(p, file_.end() - p) == load(2) ? valid : invalid;
+    }
+    return verified_ == valid;
+  }
+
+  /** A 64-bit checksum which consumes eight bytes per step. */
+  static uint64_t checksum(const char* p, size_t n) {
+    uint64_t h = 0x9e3779b97f4a7c15ull ^ n;
+    for (; n >= 8; p += 8, n -= 8) {
+      uint64_t w;
+      memcpy(&w, p, 8);
+      h = mix(h, w);
+    }
+    uint64_t w = 0;
+    memcpy(&w, p, n);
+    h = mix(h, w);
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+  }
+
+ private:
+  MappedFile file_;
+  enum Status {
+    unknown,
+    valid,
+    invalid
+  };
+  mutable Status verified_;
+
+  static constexpr uint64_t magic() {
+    return 0x3176626c69747570ull;
+  }
+  static constexpr size_t header_size() {
+    return 3 * sizeof(uint64_t);
+  }
+  uint64_t load(size_t i) const {
+    uint64_t res;
+    memcpy(&res, file_.begin() + i * sizeof(uint64_t), sizeof(uint64_t));
+    return res;
+  }
+  static uint64_t mix(uint64_t h, uint64_t w) {
+    w *= 0x87c37b91114253d5ull;
+    w = (w << 31) | (w >> 33);
+    h ^= w * 0x4cf5ad432745937full;
+    return ((h << 27) | (h >> 37)) * 5 + 0x52dce729;
+  }
+};
+
+} // namespace cpputil
+
+#endif
@@ -0,0 +1,331 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_SERIALIZE_BINARY_WRITER_H
+#define CPPUTIL_INCLUDE_SERIALIZE_BINARY_WRITER_H
+
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdint.h>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "include/io/stream_access.h"
+#include "include/meta/has_unique_representation.h"
+#include "include/meta/is_char_pointer.h"
+#include "include/meta/is_contiguous_sequence.h"
+#include "include/meta/is_reflected.h"
+#include "include/meta/is_stl_map.h"
+#include "include/meta/is_stl_pair.h"
+#include "include/meta/is_stl_sequence.h"
+#include "include/meta/is_stl_set.h"
+#include "include/meta/is_stl_string.h"
+#include "include/meta/is_stl_tuple.h"
+#include "include/serialize/binary_key_index.h"
+#include "include/serialize/varint.h"
+
+namespace cpputil {
+
+/** Writes values in a compact binary format with the same dispatch structure
+    as TextWriter. Multi-byte integers are varints (zigzag encoded if signed),
+    bytes, bools and floating point values are written raw, and strings and
+    containers are prefixed by their length as a varint. Container elements
+    whose bytes are all part of their value (see has_unique_representation)
+    are written raw, so that BinaryView can index them in place, and
+    contiguous sequences of them are written with a single bulk copy.
+    Associative containers write all of their keys and then all of their
+    mapped values, and sorted ones whose keys are not raw index their keys
+    (see has_binary_key_index). The format is not portable across platforms
+    with different endianness. */
+template <typename T, typename Enable = void>
+struct BinaryWriter;
+
+/** Encodes values in the BinaryWriter format directly into memory. It is
+    defined for types whose encoded size has a cheap upper bound, which lets
+    container elements be encoded straight into a stream's put area. */
+template <typename T, typename Enable = void>
+struct BinaryEncoder;
+
+template <typename T>
+struct BinaryEncoder < T, typename std::enable_if < std::is_integral<T>::value &&
+    (sizeof(T) > 1) >::type > {
+  static size_t max_size(const T&) {
+    return VarintWriter<T>::max_bytes();
+  }
+  static char* encode(const T& t, char* p) {
+    return p + VarintWriter<T>::encode(t, p);
+  }
+};
+
+template <typename T>
+struct BinaryEncoder < T, typename std::enable_if < std::is_floating_point<T>::value ||
+    (std::is_integral<T>::value && sizeof(T) == 1) >::type > {
+  static size_t max_size(const T&) {
+    return sizeof(T);
+  }
+  static char* encode(const T& t, char* p) {
+    memcpy(p, (const char*)&t, sizeof(T));
+    return p + sizeof(T);
+  }
+};
+
+template <typename T>
+struct BinaryEncoder<T, typename std::enable_if<is_stl_string<T>::value>::type> {
+  static size_t max_size(const T& t) {
+    return VarintWriter<size_t>::max_bytes() + t.size();
+  }
+  static char* encode(const T& t, char* p) {
+    p += VarintWriter<size_t>::encode(t.size(), p);
+    memcpy(p, t.data(), t.size());
+    return p + t.size();
+  }
+};
+
+template <typename T>
+struct BinaryEncoder<T, typename std::enable_if<is_stl_pair<T>::value>::type> {
+  typedef BinaryEncoder<typename std::remove_const<typename T::first_type>::type> First;
+  typedef BinaryEncoder<typename std::remove_const<typename T::second_type>::type> Second;
+
+  static size_t max_size(const T& t) {
+    return First::max_size(t.first) + Second::max_size(t.second);
+  }
+  static char* encode(const T& t, char* p) {
+    return Second::encode(t.second, First::encode(t.first, p));
+  }
+};
+
+/** True if T has a BinaryEncoder. */
+template <typename T>
+struct has_binary_encoder {
+ private:
+  template <typename U>
+  static auto test(int) -> decltype(BinaryEncoder<U>::max_size(std::declval<const U&>()),
+                                    std::true_type());
+  template <typename U>
+  static std::false_type test(...);
+
+ public:
+  static constexpr bool value = decltype(test<T>(0))::value;
+};
+
+/** Writes one element of a container. */
+template <typename T, typename Enable = void>
+struct BinaryElementWriter {
+  void operator()(std::ostream& os, const T& t) const {
+    BinaryWriter<T>()(os, t);
+  }
+};
+
+/** Elements with an encoder are encoded in place when the put area has room. */
+template <typename T>
+struct BinaryElementWriter < T, typename std::enable_if < !has_unique_representation<T>::value &&
+    has_binary_encoder<T>::value >::type > {
+  void operator()(std::ostream& os, const T& t) const {
+    const auto sb = os.rdbuf();
+    const auto p = StreamAccess::put_begin(sb);
+    if (size_t(StreamAccess::put_end(sb) - p) >= BinaryEncoder<T>::max_size(t)) {
+      StreamAccess::put_commit(sb, BinaryEncoder<T>::encode(t, p));
+    } else {
+      BinaryWriter<T>()(os, t);
+    }
+  }
+};
+
+template <typename T>
+struct BinaryElementWriter<T, typename std::enable_if<has_unique_representation<T>::value>::type> {
+  void operator()(std::ostream& os, const T& t) const {
+    StreamAccess::put(os.rdbuf(), (const char*)&t, sizeof(T));
+  }
+};
+
+template <typename T>
+struct BinaryWriter < T, typename std::enable_if < std::is_integral<T>::value &&
+    (sizeof(T) > 1) >::type > {
+  void operator()(std::ostream& os, const T& t) const {
+    VarintWriter<T>()(os, t);
+  }
+};
+
+template <typename T>
+struct BinaryWriter < T, typename std::enable_if < std::is_floating_point<T>::value ||
+    (std::is_integral<T>::value && sizeof(T) == 1) >::type > {
+  void operator()(std::ostream& os, const T& t) const {
+    StreamAccess::put(os.rdbuf(), (const char*)&t, sizeof(T));
+  }
+};
+
+template <typename T>
+struct BinaryWriter < T,
+    typename std::enable_if < is_char_pointer<T>::value || is_stl_string<T>::value >::type > {
+  void operator()(std::ostream& os, const T& t) const {
+    write(os, &t[0], size(t));
+  }
+
+ private:
+  template <typename S>
+  static size_t size(const S& s) {
+    return s.size();
+  }
+  static size_t size(const char* s) {
+    return strlen(s);
+  }
+  static void write(std::ostream& os, const char* s, size_t n) {
+    // Short strings share a single write with their length prefix
+    char buffer[64];
+    const auto prefix = VarintWriter<size_t>::encode(n, buffer);
+    if (prefix + n <= sizeof(buffer)) {
+      memcpy(buffer + prefix, s, n);
+      StreamAccess::put(os.rdbuf(), buffer, prefix + n);
+    } else {
+      StreamAccess::put(os.rdbuf(), buffer, prefix);
+      StreamAccess::put(os.rdbuf(), s, n);
+    }
+  }
+};
+
+template <typename T>
+struct BinaryWriter<T, typename std::enable_if <is_stl_pair<T>::value>::type> {
+  void operator()(std::ostream& os, const T& t) const {
+    BinaryWriter<typename std::remove_const<typename T::first_type>::type>()(os, t.first);
+    BinaryWriter<typename std::remove_const<typename T::second_type>::type>()(os, t.second);
+  }
+};
+
+template <typename T>
+struct BinaryWriter < T, typename std::enable_if < is_contiguous_sequence<T>::value &&
+    has_unique_representation<typename T::value_type>::value >::type > {
+  void operator()(std::ostream& os, const T& t) const {
+    VarintWriter<size_t>()(os, t.size());
+    StreamAccess::put(os.rdbuf(), (const char*)t.data(), t.size() * sizeof(typename T::value_type));
+  }
+};
+
+template <typename T>
+struct BinaryWriter < T, typename std::enable_if < is_stl_sequence<T>::value &&
+    !(is_contiguous_sequence<T>::value &&
+      has_unique_representation<typename T::value_type>::value) >::type > {
+  void operator()(std::ostream& os, const T& t) const {
+    VarintWriter<size_t>()(os, std::distance(t.begin(), t.end()));
+    for (const auto& elem : t) {
+      BinaryElementWriter<typename T::value_type>()(os, elem);
+    }
+  }
+};
+
+/** Writes the keys of a set or map, which key() extracts from its elements. */
+template <typename T, typename Key>
+typename std::enable_if < !has_binary_key_index<T>::value, void >::type
+write_binary_keys(std::ostream& os, const T& t, Key key) {
+  for (const auto& elem : t) {
+    BinaryElementWriter<typename T::key_type>()(os, key(elem));
+  }
+}
+
+/** Keys with an index are staged in a buffer to learn their offsets. */
+template <typename T, typename Key>
+typename std::enable_if<has_binary_key_index<T>::value, void>::type
+write_binary_keys(std::ostream& os, const T& t, Key key) {
+  std::stringstream keys;
+  std::vector<uint64_t> index;
+  index.reserve(t.size() + 1);
+  for (const auto& elem : t) {
+    index.push_back(keys.tellp());
+    BinaryElementWriter<typename T::key_type>()(keys, key(elem));
+  }
+  index.push_back(keys.tellp());
+
+  const auto bytes = keys.str();
+  StreamAccess::put(os.rdbuf(), (const char*)index.data(), index.size() * sizeof(uint64_t));
+  StreamAccess::put(os.rdbuf(), bytes.data(), bytes.size());
+}
+
+template <typename T>
+struct BinaryWriter<T, typename std::enable_if<is_stl_set<T>::value>::type> {
+  void operator()(std::ostream& os, const T& t) const {
+    VarintWriter<size_t>()(os, t.size());
+    write_binary_keys(os, t, [](const typename T::value_type & elem) -> const typename T::key_type& {
+      return elem;
+    });
+  }
+};
+
+template <typename T>
+struct BinaryWriter<T, typename std::enable_if<is_stl_map<T>::value>::type> {
+  void operator()(std::ostream& os, const T& t) const {
+    VarintWriter<size_t>()(os, t.size());
+    write_binary_keys(os, t, [](const typename T::value_type & elem) -> const typename T::key_type& {
+      return elem.first;
+    });
+    for (const auto& elem : t) {
+      BinaryElementWriter<typename T::mapped_type>()(os, elem.second);
+    }
+  }
+};
+
+template <typename T>
+class BinaryWriter <T, typename std::enable_if <is_stl_tuple<T>::value>::type> {
+ public:
+  void operator()(std::ostream& os, const T& t) const {
+    Helper<T, 0, std::tuple_size<T>::value>()(os, t);
+  }
+
+ private:
+  template <typename Tuple, size_t Begin, size_t End>
+  struct Helper {
+    void operator()(std::ostream& os, const Tuple& t) {
+      BinaryWriter<typename std::tuple_element<Begin, Tuple>::type>()(os, std::get<Begin>(t));
+      Helper < Tuple, Begin + 1, End > ()(os, t);
+    }
+  };
+
+  template <typename Tuple, size_t End>
+  struct Helper<Tuple, End, End> {
+    void operator()(std::ostream&, const Tuple&) { }
+  };
+};
+
+/** Reflected structs are written field by field, like tuples, whether they
+    stand alone or are container elements. They are never written raw, so a
+    struct has a single encoding and its padding never reaches the output. */
+template <typename T>
+class BinaryWriter <T, typename std::enable_if <is_reflected<T>::value>::type> {
+ public:
+  void operator()(std::ostream& os, const T& t) const {
+    const auto fields = t.cpputil_fields();
+    typedef decltype(fields) Tuple;
+    Helper<Tuple, 0, std::tuple_size<Tuple>::value>()(os, fields);
+  }
+
+ private:
+  template <typename Tuple, size_t Begin, size_t End>
+  struct Helper {
+    void operator()(std::ostream& os, const Tuple& t) {
+      typedef typename std::tuple_element<Begin, Tuple>::type Field;
+      BinaryWriter<typename std::decay<Field>::type>()(os, std::get<Begin>(t));
+      Helper < Tuple, Begin + 1, End > ()(os, t);
+    }
+  };
+
+  template <typename Tuple, size_t End>
+  struct Helper<Tuple, End, End> {
+    void operator()(std::ostream&, const Tuple&) { }
+  };
+};
+
+} // namespace cpputil
+
+#endif
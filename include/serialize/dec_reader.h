@@ -15,23 +15,361 @@
 #ifndef CPPUTIL_INCLUDE_SERIALIZE_DEC_READER_H
 #define CPPUTIL_INCLUDE_SERIALIZE_DEC_READER_H
 
+#include <cstdlib>
 #include <iostream>
+#include <limits>
+#include <stdint.h>
+#include <string>
 #include <type_traits>
 
+#include "include/io/stream_access.h"
+
 namespace cpputil {
 
+/** Parsing which DecReader shares across types. Characters come from a
+    Source: either a range of chars, or a streambuf, through the inline
+    sgetc() and sbumpc() which only make virtual calls when the get area
+    runs dry. */
+class DecReaderBase {
+ protected:
+  /** Reads a T from is with Reader::parse(). Numbers which end inside the
+      streambuf's get area are parsed from it directly, and anything else
+      goes through the streambuf one character at a time. Streams which are
+      not in base ten or the classic locale are left to operator>>. */
+  template <typename Reader, typename T>
+  static void read(std::istream& is, T& t) {
+    if (!fast(is)) {
+      is >> t;
+      return;
+    } else if (!sentry(is)) {
+      return;
+    }
+
+    auto sb = is.rdbuf();
+    const auto end = StreamAccess::get_end(sb);
+    BufferSource b(StreamAccess::get_begin(sb), end);
+    auto ok = Reader::parse(b, t);
+    if (b.get() < end) {
+      StreamAccess::get_consume(sb, b.get());
+    } else {
+      StreamSource s(sb);
+      ok = Reader::parse(s, t);
+      if (s.peek() == std::char_traits<char>::eof()) {
+        is.setstate(std::ios::eofbit);
+      }
+    }
+    if (!ok) {
+      is.setstate(std::ios::failbit);
+    }
+  }
+
+  class StreamSource {
+   public:
+    StreamSource(std::streambuf* sb) : sb_(sb) { }
+    int peek() {
+      return sb_->sgetc();
+    }
+    void bump() {
+      sb_->sbumpc();
+    }
+
+   private:
+    std::streambuf* sb_;
+  };
+
+  class BufferSource {
+   public:
+    BufferSource(const char* begin, const char* end) : p_(begin), end_(end) { }
+    int peek() const {
+      return p_ < end_ ? (unsigned char)*p_ : std::char_traits<char>::eof();
+    }
+    void bump() {
+      ++p_;
+    }
+    const char* get() const {
+      return p_;
+    }
+
+   private:
+    const char* p_;
+    const char* end_;
+  };
+
+  /** Returns true if is would read numbers as the classic locale does in
+      base ten, which is all the parsers below understand. */
+  static bool fast(std::istream& is) {
+    const auto base = is.flags() & std::ios::basefield;
+    return base == std::ios::dec && is_classic(is);
+  }
+
+  /** Does the work of std::istream::sentry: flushes the tied stream and
+      skips whitespace. Returns false, having set the stream state, if there
+      is nothing to read. */
+  static bool sentry(std::istream& is) {
+    if (!is.good()) {
+      is.setstate(std::ios::failbit);
+      return false;
+    }
+    if (is.tie() != nullptr) {
+      is.tie()->flush();
+    }
+    if (is.flags() & std::ios::skipws) {
+      auto sb = is.rdbuf();
+      for (auto c = sb->sgetc(); ; c = sb->snextc()) {
+        if (c == std::char_traits<char>::eof()) {
+          is.setstate(std::ios::failbit | std::ios::eofbit);
+          return false;
+        } else if (!isspace(c)) {
+          break;
+        }
+      }
+    }
+    return true;
+  }
+
+  static bool isspace(int c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+  }
+  static bool isdigit(int c) {
+    return c >= '0' && c <= '9';
+  }
+};
+
 template <typename T, typename Enable = void>
 struct DecReader;
 
+/** Character and boolean types keep the meaning operator>> gives them. */
 template <typename T>
-struct DecReader <T, typename std::enable_if <std::is_arithmetic<T>::value>::type> {
+struct DecReader < T, typename std::enable_if < std::is_arithmetic<T>::value &&
+    (std::is_same<T, bool>::value || sizeof(T) == 1 || std::is_same<T, wchar_t>::value ||
+     std::is_same<T, char16_t>::value || std::is_same<T, char32_t>::value) >::type > {
   void operator()(std::istream& is, T& t) const {
     is >> t;
   }
 };
 
-} // namespace cpputil
+/** Reads integers in the manner of operator>>, including its handling of
+    the stream state: failbit and a value of zero if there are no digits,
+    failbit and the nearest representable value on overflow, and eofbit if
+    the input ends the number. */
+template <typename T>
+class DecReader < T, typename std::enable_if < std::is_integral<T>::value &&
+  !(std::is_same<T, bool>::value || sizeof(T) == 1 || std::is_same<T, wchar_t>::value ||
+    std::is_same<T, char16_t>::value || std::is_same<T, char32_t>::value) >::type > :
+  private DecReaderBase {
+ public:
+  void operator()(std::istream& is, T& t) const {
+    read<DecReader>(is, t);
+  }
 
-#endif
+  /** Parses a number at the start of [begin, end) in the manner of
+      std::from_chars. Returns the address past the last character consumed,
+      or nullptr if there is no number or it does not fit in T. */
+  static const char* parse(const char* begin, const char* end, T& t) {
+    BufferSource s(begin, end);
+    return parse(s, t) ? s.get() : nullptr;
+  }
+
+ private:
+  friend class DecReaderBase;
+  typedef typename std::make_unsigned<T>::type U;
+
+  template <typename Source>
+  static bool parse(Source& s, T& t) {
+    auto c = s.peek();
+    const auto neg = c == '-';
+    if (neg || c == '+') {
+      s.bump();
+      c = s.peek();
+    }
+
+    // Negative unsigned values wrap, as they do for strtoull
+    const U limit = std::is_signed<T>::value ? U(std::numeric_limits<T>::max()) + U(neg) : U(-1);
+    U u = 0;
+    auto digits = false;
+    auto overflow = false;
+    for (; isdigit(c); s.bump(), c = s.peek()) {
+      digits = true;
+      const U d = c - '0';
+      if (u > (limit - d) / 10) {
+        overflow = true;
+      } else {
+        u = u * 10 + d;
+      }
+    }
+
+    if (!digits) {
+      t = 0;
+      return false;
+    } else if (overflow) {
+      t = std::is_signed<T>::value && neg ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max();
+      return false;
+    }
+    t = neg ? T(U(0) - u) : T(u);
+    return true;
+  }
+};
 
+/** Reads floating point values in the manner of operator>>, with the same
+    stream state rules as for integers (overflow yields plus or minus the
+    largest finite value). Numbers with at most as many significant digits
+    as T holds exactly and a small decimal exponent are computed with a
+    single correctly rounded multiply or divide; anything else is handed to
+    strtod. Credit goes to: William D. Clinger, How to Read Floating Point
+    Numbers Accurately (PLDI 1990). */
+template <typename T>
+class DecReader<T, typename std::enable_if<std::is_floating_point<T>::value>::type> :
+  private DecReaderBase {
+ public:
+  void operator()(std::istream& is, T& t) const {
+    read<DecReader>(is, t);
+  }
+
+  /** Parses a number at the start of [begin, end) in the manner of
+      std::from_chars. Returns the address past the last character consumed,
+      or nullptr if there is no number or it is out of range. */
+  static const char* parse(const char* begin, const char* end, T& t) {
+    BufferSource s(begin, end);
+    return parse(s, t) ? s.get() : nullptr;
+  }
+
+ private:
+  friend class DecReaderBase;
+
+  /** The characters of a number, kept for strtod. Short numbers never
+      allocate. */
+  class Chars {
+   public:
+    Chars() : n_(0) { }
+    void push_back(char c) {
+      if (n_ + 1 < sizeof(buf_)) {
+        buf_[n_++] = c;
+      } else {
+        if (spill_.empty()) {
+          spill_.assign(buf_, n_);
+        }
+        spill_.push_back(c);
+      }
+    }
+    const char* c_str() {
+      if (!spill_.empty()) {
+        return spill_.c_str();
+      }
+      buf_[n_] = '\0';
+      return buf_;
+    }
+
+   private:
+    char buf_[64];
+    size_t n_;
+    std::string spill_;
+  };
+
+  template <typename Source>
+  static bool parse(Source& s, T& t) {
+    Chars chars;
+    uint64_t mantissa = 0;
+    int sig_digits = 0;
+    int exp10 = 0;
+    auto found_mantissa = false;
+
+    auto c = s.peek();
+    const auto neg = c == '-';
+    if (neg || c == '+') {
+      chars.push_back(c);
+      s.bump();
+      c = s.peek();
+    }
+
+    // The grammar accepted by num_get: digits with at most one decimal point,
+    // then an exponent, which is only accepted after some mantissa digits
+    for (auto found_point = false; ; s.bump(), c = s.peek()) {
+      if (isdigit(c)) {
+        found_mantissa = true;
+        if (sig_digits > 0 || c != '0') {
+          if (sig_digits < 19) {
+            mantissa = mantissa * 10 + (c - '0');
+          } else {
+            ++exp10;
+          }
+          ++sig_digits;
+        }
+        exp10 -= found_point;
+      } else if (c == '.' && !found_point) {
+        found_point = true;
+      } else {
+        break;
+      }
+      chars.push_back(c);
+    }
+
+    auto exp_ok = true;
+    if (found_mantissa && (c == 'e' || c == 'E')) {
+      chars.push_back(c);
+      s.bump();
+      c = s.peek();
+      const auto exp_neg = c == '-';
+      if (exp_neg || c == '+') {
+        chars.push_back(c);
+        s.bump();
+        c = s.peek();
+      }
+      int e = 0;
+      exp_ok = false;
+      for (; isdigit(c); s.bump(), c = s.peek()) {
+        exp_ok = true;
+        e = e < 100000 ? e * 10 + (c - '0') : e;
+        chars.push_back(c);
+      }
+      exp10 += exp_neg ? -e : e;
+    }
+
+    if (!found_mantissa || !exp_ok) {
+      t = 0;
+      return false;
+    }
+
+    if (sig_digits <= 19 && mantissa <= max_exact() && exp10 >= -max_pow10() && exp10 <= max_pow10()) {
+      t = exp10 < 0 ? T(mantissa) / pow10(-exp10) : T(mantissa) * pow10(exp10);
+      t = neg ? -t : t;
+      return true;
+    }
 
+    t = strto(chars.c_str(), T());
+    if (t == std::numeric_limits<T>::infinity() || t == -std::numeric_limits<T>::infinity()) {
+      t = t > 0 ? std::numeric_limits<T>::max() : -std::numeric_limits<T>::max();
+      return false;
+    }
+    return true;
+  }
+
+  /** The largest integer such that it and every smaller one are exact in T. */
+  static constexpr uint64_t max_exact() {
+    return std::numeric_limits<T>::digits < 64 ? uint64_t(1) << std::numeric_limits<T>::digits : 0;
+  }
+  /** The largest power of ten which is exact in T. */
+  static constexpr int max_pow10() {
+    return std::numeric_limits<T>::digits >= 64 ? -1 : std::numeric_limits<T>::digits >= 53 ? 22 : 10;
+  }
+  static T pow10(int e) {
+    static const T table[] = {
+      1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    return table[e];
+  }
+
+  static float strto(const char* s, float) {
+    return strtof(s, nullptr);
+  }
+  static double strto(const char* s, double) {
+    return strtod(s, nullptr);
+  }
+  static long double strto(const char* s, long double) {
+    return strtold(s, nullptr);
+  }
+};
+
+} // namespace cpputil
+
+#endif
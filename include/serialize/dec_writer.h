@@ -15,26 +15,125 @@
 #ifndef CPPUTIL_INCLUDE_SERIALIZE_DEC_WRITER_H
 #define CPPUTIL_INCLUDE_SERIALIZE_DEC_WRITER_H
 
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <type_traits>
 
+#include "include/io/stream_access.h"
+
 namespace cpputil {
 
 template <typename T, typename Enable = void>
 struct DecWriter;
 
+/** Character and boolean types keep the meaning operator<< gives them. */
 template <typename T>
-struct DecWriter <T, typename std::enable_if <std::is_arithmetic<T>::value>::type> {
+struct DecWriter < T, typename std::enable_if < std::is_arithmetic<T>::value &&
+    (std::is_same<T, bool>::value || sizeof(T) == 1 || std::is_same<T, wchar_t>::value ||
+     std::is_same<T, char16_t>::value || std::is_same<T, char32_t>::value) >::type > {
   void operator()(std::ostream& os, const T& t) const {
     const auto f = os.flags(std::ios::dec);
     os << t;
-    os.setf(f);
+    os.flags(f);
   }
 };
 
-} // namespace cpputil
+/** Numbers are formatted into a buffer on the stack and copied into the
+    streambuf in one piece. The output is what operator<< would
+    produce with only std::ios::dec set; streams which pad or are not in the
+    classic locale go through operator<< as before. */
+template <typename T>
+class DecWriter < T, typename std::enable_if < std::is_arithmetic<T>::value &&
+  !(std::is_same<T, bool>::value || sizeof(T) == 1 || std::is_same<T, wchar_t>::value ||
+    std::is_same<T, char16_t>::value || std::is_same<T, char32_t>::value) >::type > {
+ public:
+  void operator()(std::ostream& os, const T& t) const {
+    if (os.width() != 0 || !is_classic(os)) {
+      const auto f = os.flags(std::ios::dec);
+      os << t;
+      os.flags(f);
+      return;
+    }
 
-#endif
+    char buffer[buffer_size()];
+    size_t n = 0;
+    const auto p = format(buffer, t, os.precision() < 0 ? 6 : os.precision(), n);
+    if (p == nullptr) {
+      const auto f = os.flags(std::ios::dec);
+      os << t;
+      os.flags(f);
+    } else if (os.good()) {
+      if (os.tie() != nullptr) {
+        os.tie()->flush();
+      }
+      if (StreamAccess::put(os.rdbuf(), p, n) != std::streamsize(n)) {
+        os.setstate(std::ios::badbit);
+      }
+    }
+  }
+
+ private:
+  static constexpr size_t buffer_size() {
+    return 64;
+  }
+
+  /** Writes t somewhere in buffer, sets n to its length, and returns its
+      first character, or nullptr if it does not fit. Integers are written
+      from the end of the buffer, two digits at a time. */
+  template <typename U = T>
+  static typename std::enable_if<std::is_integral<U>::value, const char*>::type
+  format(char* buffer, const U& t, std::streamsize, size_t& n) {
+    typedef typename std::make_unsigned<U>::type V;
+    const auto neg = t < 0;
+    V v = neg ? V(0) - V(t) : V(t);
+
+    auto p = buffer + buffer_size();
+    for (; v >= 100; v /= 100) {
+      p -= 2;
+      memcpy(p, digits() + (v % 100) * 2, 2);
+    }
+    if (v >= 10) {
+      p -= 2;
+      memcpy(p, digits() + v * 2, 2);
+    } else {
+      *--p = char('0' + v);
+    }
+    if (neg) {
+      *--p = '-';
+    }
+    n = buffer + buffer_size() - p;
+    return p;
+  }
+
+  /** Floating point values use the conversion num_put makes for them. */
+  template <typename U = T>
+  static typename std::enable_if<std::is_floating_point<U>::value, const char*>::type
+  format(char* buffer, const U& t, std::streamsize precision, size_t& n) {
+    const auto res = print(buffer, t, int(precision));
+    if (res < 0 || size_t(res) >= buffer_size()) {
+      return nullptr;
+    }
+    n = res;
+    return buffer;
+  }
+
+  static int print(char* buffer, double d, int precision) {
+    return snprintf(buffer, buffer_size(), "%.*g", precision, d);
+  }
+  static int print(char* buffer, long double d, int precision) {
+    return snprintf(buffer, buffer_size(), "%.*Lg", precision, d);
+  }
 
+  static const char* digits() {
+    return "0001020304050607080910111213141516171819"
+           "2021222324252627282930313233343536373839"
+           "4041424344454647484950515253545556575859"
+           "6061626364656667686970717273747576777879"
+           "8081828384858687888990919293949596979899";
+  }
+};
 
+} // namespace cpputil
 
+#endif
@@ -17,9 +17,13 @@
 
 #include <array>
 #include <cctype>
+#include <cstring>
+#include <immintrin.h>
 #include <iostream>
+#include <stdint.h>
 #include <type_traits>
 
+#include "include/io/stream_access.h"
 #include "include/meta/bit_width.h"
 
 namespace cpputil {
@@ -33,32 +37,179 @@ namespace cpputil {
 template <typename T, size_t Group = 8, typename Enable = void>
 struct HexReader;
 
+/** Reads the format produced by HexWriter. Sets failbit, leaving t
+    unchanged, on the first character which is not a hex digit or a group
+    separator, having consumed that character. When the whole value is
+    already in the streambuf's get area it is validated and decoded in
+    place, with AVX2 compares and SSSE3 shuffles where they are available;
+    otherwise characters are read one at a time. */
 template <typename T, size_t Group>
-struct HexReader <T, Group, typename std::enable_if <std::is_arithmetic<T>::value>::type> {
+class HexReader <T, Group, typename std::enable_if <std::is_arithmetic<T>::value>::type> {
+ public:
   void operator()(std::istream& is, T& t) const {
-    std::array < uint8_t, bit_width<T>::value / 8 > buffer;
+    auto sb = is.rdbuf();
+    const auto begin = StreamAccess::get_begin(sb);
+    if (!is.good() || size_t(StreamAccess::get_end(sb) - begin) < chars()) {
+      read_chars(is, t);
+      return;
+    }
+
+    size_t used = 0;
+    const auto ok = decode(begin, t, used);
+    StreamAccess::get_consume(sb, begin + used);
+    die_if(!ok);
+  }
+
+  /** Decodes a value at the start of [begin, end). Returns the address past
+      it, or nullptr if it is malformed or incomplete. */
+  static const char* parse(const char* begin, const char* end, T& t) {
+    size_t used = 0;
+    if (size_t(end - begin) >= chars()) {
+      return decode(begin, t, used) ? begin + used : nullptr;
+    }
+    char temp[chars()];
+    memset(temp, 0, chars());
+    memcpy(temp, begin, end - begin);
+    return decode(temp, t, used) ? begin + used : nullptr;
+  }
+
+ private:
+  static constexpr size_t nibbles() {
+    return bit_width<T>::value / 4;
+  }
+  static constexpr size_t bytes() {
+    return bit_width<T>::value / 8;
+  }
+  /** The number of characters in a value, including group separators. */
+  static constexpr size_t chars() {
+    return nibbles() + (nibbles() - 1) / Group;
+  }
+
+  /** Decodes the chars() characters at s. On success returns true and sets
+      used to chars(). Otherwise returns false and sets used to the number
+      of characters up to and including the first bad one. */
+  static bool decode(const char* s, T& t, size_t& used) {
+#if defined(__AVX2__) && defined(__AVX__)
+    if (nibbles() <= 16 && chars() <= 32) {
+      return decode_simd(s, t, used);
+    }
+#endif
+    return decode_scalar(s, t, used);
+  }
+
+  static bool decode_scalar(const char* s, T& t, size_t& used) {
+    std::array<uint8_t, bytes()> buffer;
     buffer.fill(0);
 
-    for (size_t i = bit_width<T>::value / 4; i > 0; --i) {
-      if (i < bit_width<T>::value / 4 && i % Group == 0) {
+    used = 0;
+    for (size_t i = nibbles(); i > 0; --i) {
+      if (i < nibbles() && i % Group == 0 && s[used++] != ' ') {
+        return false;
+      }
+      const auto c = (unsigned char) s[used++];
+      if (!isxdigit(c)) {
+        return false;
+      }
+      buffer[(i - 1) / 2] |= nibble(c) << (i % 2 == 0 ? 4 : 0);
+    }
+
+    memcpy((void*)&t, buffer.data(), bytes());
+    return true;
+  }
+
+#if defined(__AVX2__) && defined(__AVX__)
+  static bool decode_simd(const char* s, T& t, size_t& used) {
+    const auto& l = layout();
+
+    char temp[32];
+    memcpy(temp, s, chars());
+    memset(temp + chars(), 0, 32 - chars());
+    const auto c = _mm256_loadu_si256((const __m256i*)temp);
+
+    // Classify every character at once and compare against where digits
+    // and separators should be
+    const auto lower = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+    const auto digit = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)),
+                                        _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+    const auto letter = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                                         _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+    const auto space = _mm256_cmpeq_epi8(c, _mm256_set1_epi8(' '));
+    const uint32_t hex = _mm256_movemask_epi8(_mm256_or_si256(digit, letter));
+    const uint32_t sep = _mm256_movemask_epi8(space);
+    const uint32_t errors = ~((hex & l.digits) | (sep & l.separators)) & (l.digits | l.separators);
+    if (errors != 0) {
+      used = __builtin_ctz(errors) + 1;
+      return false;
+    }
+
+    // Digits are their low nibble, letters their low nibble plus nine.
+    // Gather the digits out from between the separators, then fold pairs
+    // of them into bytes, most significant first
+    const auto n = _mm256_add_epi8(_mm256_and_si256(c, _mm256_set1_epi8(0x0f)),
+                                   _mm256_and_si256(letter, _mm256_set1_epi8(9)));
+    const auto lo = _mm_shuffle_epi8(_mm256_castsi256_si128(n), _mm_loadu_si128((const __m128i*)l.lo));
+    const auto hi = _mm_shuffle_epi8(_mm256_extracti128_si256(n, 1), _mm_loadu_si128((const __m128i*)l.hi));
+    const auto pairs = _mm_maddubs_epi16(_mm_or_si128(lo, hi), _mm_set1_epi16(0x0110));
+    const uint64_t u = __builtin_bswap64(_mm_cvtsi128_si64(_mm_packus_epi16(pairs, pairs)));
+
+    const auto v = u >> (8 * (8 - bytes()));
+    memcpy((void*)&t, &v, bytes());
+    used = chars();
+    return true;
+  }
+
+  /** Where digits and separators fall, and shuffles which gather the digits
+      out of the low and high halves of the input. */
+  struct Layout {
+    uint32_t digits;
+    uint32_t separators;
+    int8_t lo[16];
+    int8_t hi[16];
+
+    Layout() : digits(0), separators(0) {
+      memset(lo, -1, 16);
+      memset(hi, -1, 16);
+      size_t pos = 0;
+      for (size_t i = nibbles(), j = 0; i > 0; --i, ++j) {
+        if (i < nibbles() && i % Group == 0) {
+          separators |= 1u << pos++;
+        }
+        digits |= 1u << pos;
+        (pos < 16 ? lo[j] : hi[j]) = pos % 16;
+        ++pos;
+      }
+    }
+  };
+
+  static const Layout& layout() {
+    static const Layout l;
+    return l;
+  }
+#endif
+
+  static uint8_t nibble(unsigned char c) {
+    return (c & 0x0f) + (c & 0x40 ? 9 : 0);
+  }
+
+  static void read_chars(std::istream& is, T& t) {
+    std::array<uint8_t, bytes()> buffer;
+    buffer.fill(0);
+
+    for (size_t i = nibbles(); i > 0; --i) {
+      if (i < nibbles() && i % Group == 0) {
         die_if(is.get() != ' ');
       }
       const auto c = is.get();
       die_if(!isxdigit(c));
-
-      const uint8_t temp = (c >= '0' && c <= '9') ? (c - '0') : (
-        (c >= 'A' && c <= 'F') ? (c - 'A' + 10) : (c - 'a' + 10)
-      );
-      buffer[(i - 1) / 2] |= (temp << (i % 2 == 0 ? 4 : 0));
+      buffer[(i - 1) / 2] |= nibble(c) << (i % 2 == 0 ? 4 : 0);
     }
 
-    t = *((T*) buffer.data());
+    memcpy((void*)&t, buffer.data(), bytes());
   }
 };
 
-#undef die_unless
+#undef die_if
 
 } // namespace cpputil
 
 #endif
-
@@ -0,0 +1,188 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_SERIALIZE_PARALLEL_LINE_READER_H
+#define CPPUTIL_INCLUDE_SERIALIZE_PARALLEL_LINE_READER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <stddef.h>
+#include <utility>
+#include <vector>
+
+#include "include/io/membuf.h"
+#include "include/lazy/thread_pool.h"
+#include "include/serialize/text_reader.h"
+#include "include/serialize/text_style.h"
+
+namespace cpputil {
+
+/** Splits a range of memory (typically a MappedFile) into blocks of whole
+    lines and processes the blocks concurrently on a ThreadPool. Lines are
+    handed out as zero-copy [begin, end) ranges that exclude Style::eol(). A
+    trailing eol does not produce an empty final line, which matches a
+    getline() loop. Line boundaries are found with memchr(), which glibc
+    already vectorizes with the widest instructions the host supports. */
+template <typename Style = TextStyle<>>
+class ParallelLineReader {
+ public:
+  /** Lines are dispatched in blocks of roughly block_size bytes. At most
+      window blocks per pool thread are in flight in transform() and read(),
+      which bounds the memory held by results that have not been consumed. */
+  explicit ParallelLineReader(ThreadPool& pool, size_t block_size = 1 << 22, size_t window = 4)
+    : pool_(pool), block_size_(std::max<size_t>(1, block_size)),
+      window_(std::max<size_t>(1, window * pool.size())) { }
+
+  /** Calls f(begin, end) for every line, on the pool's threads. Lines within
+      a block are visited in order, but blocks are visited concurrently, so f
+      must be safe to call from several threads at once. */
+  template <typename F>
+  void for_each(const char* begin, const char* end, F f) const {
+    std::atomic<size_t> pending(0);
+    while (begin != end) {
+      const auto next = split(begin, end);
+      pending.fetch_add(1, std::memory_order_relaxed);
+      pool_.submit([begin, next, &f, &pending] {
+        lines(begin, next, f);
+        pending.fetch_sub(1, std::memory_order_release);
+      });
+      begin = next;
+    }
+    pool_.wait_until([&pending] {
+      return pending.load(std::memory_order_acquire) == 0;
+    });
+  }
+
+  /** Calls f(begin, end, r) for every line on the pool's threads, where r is
+      a value-initialized R. Each block works on its own copy of f, so f
+      may keep per-thread state. If f returns true, r is passed to g(r) on the
+      calling thread. If ordered is true, g sees results in input order;
+      otherwise it sees each block's results as soon as the block finishes.
+      Returns false if f returned false for any line. */
+  template <typename R, typename F, typename G>
+  bool transform(const char* begin, const char* end, F f, G g, bool ordered = true) const {
+    std::deque<std::unique_ptr<Block<R>>> window;
+    bool ok = true;
+    while (begin != end || !window.empty()) {
+      // Keep the pool busy: split and submit up to the window size
+      while (begin != end && window.size() < window_) {
+        const auto next = split(begin, end);
+        window.emplace_back(new Block<R>());
+        auto b = window.back().get();
+        pool_.submit([begin, next, b, f]() mutable {
+          lines(begin, next, [b, &f](const char* lb, const char* le) {
+            b->out.emplace_back();
+            if (!f(lb, le, b->out.back())) {
+              b->out.pop_back();
+              b->ok = false;
+            }
+          });
+          b->done.store(true, std::memory_order_release);
+        });
+        begin = next;
+      }
+      // Then drain whichever block the caller is allowed to see next
+      auto ready = window.end();
+      pool_.wait_until([&window, &ready, ordered] {
+        const auto e = ordered ? window.begin() + 1 : window.end();
+        for (auto i = window.begin(); i != e; ++i) {
+          if ((*i)->done.load(std::memory_order_acquire)) {
+            ready = i;
+            return true;
+          }
+        }
+        return false;
+      });
+      for (auto& r : (*ready)->out) {
+        g(r);
+      }
+      ok &= (*ready)->ok;
+      window.erase(ready);
+    }
+    return ok;
+  }
+
+  /** Parses each line into a T with TextReader<T, Style> on the pool's
+      threads and passes the values to g(t) on the calling thread. Lines
+      that fail to parse are skipped, and cause the return value to be
+      false. */
+  template <typename T, typename G>
+  bool read(const char* begin, const char* end, G g, bool ordered = true) const {
+    return transform<T>(begin, end, Parser<T>(), g, ordered);
+  }
+
+ private:
+  template <typename R>
+  struct Block {
+    Block() : ok(true), done(false) { }
+
+    std::vector<R> out;
+    bool ok;
+    std::atomic<bool> done;
+  };
+
+  /** Each task gets its own copy of the parser, so one stream is set up per
+      block rather than per line. */
+  template <typename T>
+  struct Parser {
+    Parser() : is(&buf) { }
+    Parser(const Parser&) : Parser() { }
+
+    bool operator()(const char* begin, const char* end, T& t) {
+      buf.reset(begin, end);
+      is.clear();
+      TextReader<T, Style>()(is, t);
+      return !is.fail();
+    }
+
+    membuf buf;
+    std::istream is;
+  };
+
+  /** Returns the end of a block that starts at begin: the first line
+      boundary at or after begin + block_size_. */
+  const char* split(const char* begin, const char* end) const {
+    if ((size_t)(end - begin) <= block_size_) {
+      return end;
+    }
+    const auto p = begin + block_size_;
+    const auto eol = (const char*)memchr(p, Style::eol(), end - p);
+    return eol == nullptr ? end : eol + 1;
+  }
+
+  template <typename F>
+  static void lines(const char* begin, const char* end, F&& f) {
+    while (begin != end) {
+      const auto eol = (const char*)memchr(begin, Style::eol(), end - begin);
+      if (eol == nullptr) {
+        f(begin, end);
+        return;
+      }
+      f(begin, eol);
+      begin = eol + 1;
+    }
+  }
+
+  ThreadPool& pool_;
+  size_t block_size_;
+  size_t window_;
+};
+
+} // namespace cpputil
+
+#endif
@@ -16,8 +16,15 @@
 #define CPPUTIL_INCLUDE_SERIALIZE_SPAN_READER_H
 
 #include <iostream>
+#include <stddef.h>
+#include <stdint.h>
 #include <type_traits>
 
+#include "include/container/bit_array.h"
+#include "include/container/bit_vector.h"
+#include "include/container/range_set.h"
+#include "include/meta/is_bit_string.h"
+#include "include/meta/is_range_set.h"
 #include "include/meta/is_stl_sequence.h"
 #include "include/meta/is_stl_set.h"
 #include "include/serialize/range.h"
@@ -58,7 +65,7 @@ class SpanReader<T, Range, Style, typename std::enable_if<is_stl_sequence<T>::va
           is.get();
         }
       } else {
-        typename T::value_type v;
+        typename T::value_type v = typename T::value_type();
         TextReader<typename T::value_type, Style>()(is, v);
         die_outside(v, Range::lower(), Range::upper());
 
@@ -109,7 +116,7 @@ struct SpanReader<T, Range, Style, typename std::enable_if<is_stl_set<T>::value>
           is.get();
         }
       } else {
-        typename T::value_type v;
+        typename T::value_type v = typename T::value_type();
         TextReader<typename T::value_type, Style>()(is, v);
         die_outside(v, Range::lower(), Range::upper());
 
@@ -142,6 +149,118 @@ struct SpanReader<T, Range, Style, typename std::enable_if<is_stl_set<T>::value>
   }
 };
 
+/** Parses a span and passes each run to insert(lo, hi) as a whole, rather
+    than expanding it one value at a time. Runs arrive as they were written,
+    so a span written by SpanWriter produces maximal, increasing runs.
+    Parsing stops early if insert returns false. */
+template <typename Range, typename Style>
+struct SpanRunReader {
+  template <typename Insert>
+  void operator()(std::istream& is, Insert insert) const {
+    typedef typename Range::value_type V;
+
+    die_unless(Style::open());
+    die_unless(' ');
+
+    auto range = false;
+    auto any = false;
+    auto last = Range::lower();
+
+    while (is.peek() != Style::close()) {
+      if (is.peek() == Style::etc()) {
+        range = true;
+        while (is.peek() == Style::etc()) {
+          is.get();
+        }
+      } else {
+        V v = V();
+        TextReader<V, Style>()(is, v);
+        die_outside(v, Range::lower(), Range::upper());
+
+        // A range starts just past the last value, or at the lower bound
+        auto lo = v;
+        if (range && !(any && last >= v)) {
+          lo = any ? V(last + 1) : Range::lower();
+        }
+        range = false;
+        if (!insert(lo, v)) {
+          return;
+        }
+        any = true;
+        last = v;
+      }
+
+      die_unless(' ');
+    }
+    die_unless(Style::close());
+
+    if (range && !(any && last >= Range::upper())) {
+      insert(any ? V(last + 1) : Range::lower(), Range::upper());
+    }
+  }
+};
+
+/** Sets whole runs of bits at once. A BitVector grows to fit the largest
+    value read. Negative values, and values that could not fit (past the
+    end of a BitArray, say), set failbit. */
+template <typename T, typename Range, typename Style>
+class SpanReader<T, Range, Style, typename std::enable_if<is_bit_string<T>::value>::type> {
+ public:
+  void operator()(std::istream& is, T& t) const {
+    typedef typename Range::value_type V;
+    clear(t);
+    SpanRunReader<Range, Style>()(is, [&is, &t](V lo, V hi) {
+      // Checked before the + 1 below, which would wrap for SIZE_MAX
+      if (negative(lo) || (uintmax_t)hi >= t.max_bits()) {
+        is.setstate(std::ios::failbit);
+        return false;
+      }
+      grow(t, size_t(hi) + 1);
+      t.set_range(size_t(lo), size_t(hi) + 1);
+      return true;
+    });
+  }
+
+ private:
+  template <typename V>
+  static typename std::enable_if<std::is_signed<V>::value, bool>::type negative(V v) {
+    return v < 0;
+  }
+  template <typename V>
+  static typename std::enable_if<!std::is_signed<V>::value, bool>::type negative(V) {
+    return false;
+  }
+
+  static void clear(BitVector& t) {
+    t.resize_for_bits(0);
+  }
+  template <size_t N>
+  static void clear(BitArray<N>& t) {
+    t.unset();
+  }
+
+  static void grow(BitVector& t, size_t n) {
+    if (n > t.num_bits()) {
+      t.resize_for_bits(n);
+    }
+  }
+  template <size_t N>
+  static void grow(BitArray<N>&, size_t) { }
+};
+
+/** Decodes into space proportional to the number of runs. */
+template <typename T, typename Range, typename Style>
+struct SpanReader<T, Range, Style, typename std::enable_if<is_range_set<T>::value>::type> {
+  void operator()(std::istream& is, T& t) const {
+    t.clear();
+    SpanRunReader<Range, Style>()(is, [&t](typename Range::value_type lo,
+                                           typename Range::value_type hi) {
+      t.insert(lo, hi);
+      return true;
+    });
+  }
+};
+
 #undef die_unless
 #undef die_outside
 
@@ -15,83 +15,185 @@
 #ifndef CPPUTIL_INCLUDE_SERIALIZE_SPAN_WRITER_H
 #define CPPUTIL_INCLUDE_SERIALIZE_SPAN_WRITER_H
 
+#include <stdint.h>
+
+#include <algorithm>
 #include <iostream>
 #include <type_traits>
-#include <algorithm>
+#include <vector>
+
+#include "include/algorithm/radix_sort.h"
+#include "include/bits/bit_manip.h"
+#include "include/meta/is_bit_string.h"
+#include "include/meta/is_range_set.h"
+#include "include/meta/is_stl_sequence.h"
+#include "include/meta/is_stl_set.h"
+#include "include/serialize/text_style.h"
 
 namespace cpputil {
 
+/** Writes sorted values as runs: a run of three or more consecutive values
+    is written as lo ... hi, and shorter runs are written out in full. */
+template <typename T, typename Range, typename Style>
+class SpanEncoder {
+ public:
+  explicit SpanEncoder(std::ostream& os) : os_(os), lo_(), hi_(), run_(0) {
+    os_ << Style::open();
+  }
+
+  /** Appends a value, which must not be less than the last one. */
+  void push(const T& v) {
+    if (run_ > 0 && v == hi_ + 1) {
+      // we are in a run
+      hi_ = v;
+      ++run_;
+    } else {
+      flush();
+      lo_ = hi_ = v;
+      run_ = 1;
+    }
+  }
+
+  /** Appends the values lo through hi, which must not extend the last run. */
+  void push_run(const T& lo, const T& hi) {
+    flush();
+    lo_ = lo;
+    hi_ = hi;
+    run_ = lo == hi ? 1 : lo + 1 == hi ? 2 : 3;
+  }
+
+  /** Writes any pending run and closes the span. */
+  void finish() {
+    flush();
+    os_ << " " << Style::close();
+  }
+
+ private:
+  // using open ranges seems to make the result less readable
+  static constexpr bool use_open_range() {
+    return false;
+  }
+
+  void flush() {
+    if (run_ > 2) {
+      if (lo_ != Range::lower() || !use_open_range()) {
+        os_ << " " << lo_;
+      }
+      os_ << " ...";
+      if (hi_ != Range::upper() || !use_open_range()) {
+        os_ << " " << hi_;
+      }
+    } else if (run_ == 2) {
+      os_ << " " << lo_ << " " << hi_;
+    } else if (run_ == 1) {
+      os_ << " " << hi_;
+    }
+    run_ = 0;
+  }
+
+  std::ostream& os_;
+  T lo_;
+  T hi_;
+  size_t run_;
+};
+
 template <typename T, typename Range, typename Style = TextStyle<>, typename Enable = void>
 struct SpanWriter;
 
+/** Input that is already sorted (including every ordered set) is encoded in
+    a single pass without copying. Anything else is copied and sorted first,
+    with a radix sort for integers. */
 template <typename T, typename Range, typename Style>
-struct SpanWriter<T, Range, Style, typename std::enable_if<is_stl_sequence<T>::value>::type> {
+class SpanWriter < T, Range, Style,
+    typename std::enable_if < is_stl_sequence<T>::value || is_stl_set<T>::value >::type > {
  public:
   void operator()(std::ostream& os, const T& t) const {
-    std::vector<typename T::value_type> v(t.size());
-    std::copy(t.begin(), t.end(), v.begin());
+    if (std::is_sorted(t.begin(), t.end())) {
+      write(os, t.begin(), t.end());
+      return;
+    }
+    std::vector<typename T::value_type> v(t.begin(), t.end());
+    sort(v);
+    write(os, v.begin(), v.end());
+  }
+
+ private:
+  template <typename Itr>
+  static void write(std::ostream& os, Itr begin, Itr end) {
+    SpanEncoder<typename T::value_type, Range, Style> e(os);
+    for (; begin != end; ++begin) {
+      e.push(*begin);
+    }
+    e.finish();
+  }
+
+  template <typename V>
+  static typename std::enable_if<std::is_integral<V>::value && !std::is_same<V, bool>::value, void>::type
+  sort(std::vector<V>& v) {
+    radix_sort(v.begin(), v.end());
+  }
+
+  template <typename V>
+  static typename std::enable_if<!std::is_integral<V>::value || std::is_same<V, bool>::value, void>::type
+  sort(std::vector<V>& v) {
     std::sort(v.begin(), v.end());
+  }
+};
 
-    os << Style::open();
-
-    typename T::value_type last = v[0];
-    typename T::value_type last_run_start = v[0];
-    bool use_open_range = false; // using open ranges seems to make the result less readable
-    int run = -1;
-    for (auto cur : v) {
-      if (cur == last + 1) {
-        // we are in a run
-        ++run;
-      } else {
-        if (run > 2) {
-          // end current run
-          if (last_run_start != Range::lower() || !use_open_range) {
-            os << " " << last_run_start;
+/** Writes the indices of the set bits of a BitString. Runs are found a word
+    at a time: each step strips the lowest run of ones from a word, and full
+    words extend the current run in constant time. */
+template <typename T, typename Range, typename Style>
+struct SpanWriter<T, Range, Style, typename std::enable_if<is_bit_string<T>::value>::type> {
+  void operator()(std::ostream& os, const T& t) const {
+    typedef typename Range::value_type V;
+    SpanEncoder<V, Range, Style> e(os);
+
+    const auto words = (const uint64_t*)t.data();
+    const auto num_bits = t.num_bits();
+    // The current run is [lo, hi)
+    size_t lo = 0;
+    size_t hi = 0;
+    for (size_t i = 0, ie = (num_bits + 63) / 64; i < ie; ++i) {
+      auto w = words[i];
+      if (i + 1 == ie && num_bits % 64 != 0) {
+        w &= (0x1ull << (num_bits % 64)) - 1;
+      }
+      while (w != 0) {
+        const auto s = BitManip<uint64_t>::ntz(w);
+        const auto x = ~(w >> s);
+        const auto begin = 64 * i + s;
+        const auto len = x == 0 ? 64 : BitManip<uint64_t>::ntz(x);
+        if (begin != hi || lo == hi) {
+          if (lo != hi) {
+            e.push_run(V(lo), V(hi - 1));
           }
-          os << " ... " << last;
-        } else if (run == 2) {
-          os << " " << last_run_start << " " << last;
-        } else if (run >= 0) {
-          os << " " << last;
+          lo = begin;
         }
-        run = 1;
-        last_run_start = cur;
+        hi = begin + len;
+        // Adding the lowest set bit carries through (and clears) the run
+        w &= w + (w & (~w + 1));
       }
-      last = cur;
     }
-
-    if (run > 0) {
-      if (run > 2) {
-        // end current run
-        if (last_run_start != Range::lower() || !use_open_range) {
-          os << " " << last_run_start;
-        }
-        os << " ...";
-        if (last != Range::upper() || !use_open_range) {
-          os << " " << last;
-        }
-      } else if (run == 2) {
-        os << " " << last_run_start << " " << last;
-      } else {
-        os << " " << last;
-      }
+    if (lo != hi) {
+      e.push_run(V(lo), V(hi - 1));
     }
-
-    os << " " << Style::close();
+    e.finish();
   }
 };
 
+/** Writes each range of a RangeSet as a run. */
 template <typename T, typename Range, typename Style>
-struct SpanWriter<T, Range, Style, typename std::enable_if<is_stl_set<T>::value>::type> {
- public:
+struct SpanWriter<T, Range, Style, typename std::enable_if<is_range_set<T>::value>::type> {
   void operator()(std::ostream& os, const T& t) const {
-    std::vector<typename T::value_type> v(t.size());
-    std::copy(t.begin(), t.end(), v.begin());
-    SpanWriter<std::vector<typename T::value_type>, Range, Style> w;
-    w(os, v);
+    SpanEncoder<typename T::value_type, Range, Style> e(os);
+    for (const auto& r : t) {
+      e.push_run(r.first, r.second);
+    }
+    e.finish();
   }
 };
 
 } // namespace cpputil
 
-#endif
\ No newline at end of file
+#endif
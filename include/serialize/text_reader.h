@@ -18,6 +18,7 @@
 #include <iostream>
 #include <type_traits>
 
+#include "include/meta/is_reflected.h"
 #include "include/meta/is_stl_map.h"
 #include "include/meta/is_stl_pair.h"
 #include "include/meta/is_stl_sequence.h"
@@ -157,6 +158,36 @@ class TextReader <T, Style, typename std::enable_if <is_stl_tuple<T>::value>::ty
   };
 };
 
+/** Reflected structs are read like tuples of their fields. */
+template <typename T, typename Style>
+class TextReader <T, Style, typename std::enable_if <is_reflected<T>::value>::type> {
+ public:
+  void operator()(std::istream& is, T& t) const {
+    auto fields = t.cpputil_fields();
+    typedef decltype(fields) Tuple;
+    die_unless(Style::open());
+    Helper<Tuple, 0, std::tuple_size<Tuple>::value>()(is, fields);
+    die_unless(' ');
+    die_unless(Style::close());
+  }
+
+ private:
+  template <typename Tuple, size_t Begin, size_t End>
+  struct Helper {
+    void operator()(std::istream& is, Tuple& t) {
+      typedef typename std::tuple_element<Begin, Tuple>::type Field;
+      die_unless(' ');
+      TextReader<typename std::decay<Field>::type, Style>()(is, std::get<Begin>(t));
+      Helper < Tuple, Begin + 1, End > ()(is, t);
+    }
+  };
+
+  template <typename Tuple, size_t End>
+  struct Helper<Tuple, End, End> {
+    void operator()(std::istream&, Tuple&) { }
+  };
+};
+
 #undef die_unless
 
 } // namespace cpputil
@@ -0,0 +1,108 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_SERIALIZE_TEXT_STREAM_READER_H
+#define CPPUTIL_INCLUDE_SERIALIZE_TEXT_STREAM_READER_H
+
+#include <iostream>
+#include <type_traits>
+#include <utility>
+
+#include "include/lazy/seq.h"
+#include "include/meta/is_stl_map.h"
+#include "include/meta/is_stl_sequence.h"
+#include "include/meta/is_stl_set.h"
+#include "include/serialize/text_reader.h"
+#include "include/serialize/text_style.h"
+
+namespace cpputil {
+
+#define die_unless(c) \
+	if (is_->get() != c) { \
+		is_->setstate(std::ios::failbit); \
+		state_ = done; \
+		return false; \
+	}
+
+/** Reads the literal TextReader would read into a container of type T, but
+    one element at a time and without building the container. Elements are
+    pulled with next() (or anything else Seq provides: range-based for,
+    for_each, filter, take, ...) and each is parsed only when it is asked
+    for, so an arbitrarily large literal is processed in the memory of a
+    single element. Elements of maps are key/value pairs. The grammar and
+    its failure behaviour are TextReader's: malformed input sets failbit on
+    the stream and ends the sequence, as does the closing brace. The stream
+    must outlive the reader.
+
+    TextStreamReader<std::vector<int>> r(is);
+    for (auto i : r) { ... }
+    if (is.fail()) { ... } */
+template <typename T, typename Style = TextStyle<>, typename Enable = void>
+class TextStreamReader;
+
+template <typename T, typename Style>
+class TextStreamReader < T, Style, typename std::enable_if < is_stl_sequence<T>::value ||
+  is_stl_set<T>::value || is_stl_map<T>::value >::type > :
+  public Seq<TextStreamReader<T, Style>> {
+ public:
+  typedef typename seq_value<typename T::value_type>::type value_type;
+
+  explicit TextStreamReader(std::istream& is) : is_(&is), state_(start) { }
+
+  /** Parses the next element into v. Returns false at the end of the
+      literal or on malformed input. */
+  bool next(value_type& v) {
+    if (state_ == start) {
+      die_unless(Style::open());
+      die_unless(' ');
+      state_ = body;
+    }
+    if (state_ == done) {
+      return false;
+    }
+
+    if (is_->peek() == Style::close()) {
+      is_->get();
+      state_ = done;
+      return false;
+    }
+    TextReader<value_type, Style>()(*is_, v);
+    if (is_->fail()) {
+      state_ = done;
+      return false;
+    }
+    die_unless(' ');
+
+    return true;
+  }
+
+  /** Returns true once the closing brace or malformed input has been read. */
+  bool finished() const {
+    return state_ == done;
+  }
+
+ private:
+  std::istream* is_;
+  enum State {
+    start,
+    body,
+    done
+  } state_;
+};
+
+#undef die_unless
+
+} // namespace cpputil
+
+#endif
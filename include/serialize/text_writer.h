@@ -19,6 +19,7 @@
 #include <type_traits>
 
 #include "include/meta/is_char_pointer.h"
+#include "include/meta/is_reflected.h"
 #include "include/meta/is_stl_associative.h"
 #include "include/meta/is_stl_sequence.h"
 #include "include/meta/is_stl_pair.h"
@@ -105,6 +106,35 @@ class TextWriter <T, Style, typename std::enable_if <is_stl_tuple<T>::value>::ty
   };
 };
 
+/** Reflected structs are written like tuples of their fields. */
+template <typename T, typename Style>
+class TextWriter <T, Style, typename std::enable_if <is_reflected<T>::value>::type> {
+ public:
+  void operator()(std::ostream& os, const T& t) const {
+    const auto fields = t.cpputil_fields();
+    typedef decltype(fields) Tuple;
+    os << Style::open();
+    Helper<Tuple, 0, std::tuple_size<Tuple>::value>()(os, fields);
+    os << " " << Style::close();
+  }
+
+ private:
+  template <typename Tuple, size_t Begin, size_t End>
+  struct Helper {
+    void operator()(std::ostream& os, const Tuple& t) {
+      typedef typename std::tuple_element<Begin, Tuple>::type Field;
+      os << " ";
+      TextWriter<typename std::decay<Field>::type, Style>()(os, std::get<Begin>(t));
+      Helper < Tuple, Begin + 1, End > ()(os, t);
+    }
+  };
+
+  template <typename Tuple, size_t End>
+  struct Helper<Tuple, End, End> {
+    void operator()(std::ostream&, const Tuple&) { }
+  };
+};
+
 } // namespace cpputil
 
 #endif
@@ -0,0 +1,119 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_SERIALIZE_VARINT_H
+#define CPPUTIL_INCLUDE_SERIALIZE_VARINT_H
+
+#include <iostream>
+#include <type_traits>
+
+#include "include/io/stream_access.h"
+
+namespace cpputil {
+
+/** Writes integers in LEB128 format: seven bits per byte, least significant
+    group first, with the high bit set on every byte but the last. Signed
+    integers are zigzag encoded first so that small magnitudes stay short. */
+template <typename T, typename Enable = void>
+struct VarintWriter;
+
+template <typename T>
+struct VarintWriter < T, typename std::enable_if < std::is_integral<T>::value &&
+    !std::is_same<T, bool>::value >::type > {
+  void operator()(std::ostream& os, const T& t) const {
+    char buffer[max_bytes()];
+    StreamAccess::put(os.rdbuf(), buffer, encode(t, buffer));
+  }
+
+  /** The longest encoding of any value of type T. */
+  static constexpr size_t max_bytes() {
+    return (sizeof(T) * 8 + 6) / 7;
+  }
+
+  /** Encodes t into buffer, which must hold max_bytes(), and returns the
+      number of bytes used. Lets callers batch several fields into one write. */
+  static size_t encode(const T& t, char* buffer) {
+    typedef typename std::make_unsigned<T>::type U;
+    U u = std::is_signed<T>::value ? U(U(t) << 1) ^ U(t < 0 ? -1 : 0) : U(t);
+
+    size_t n = 0;
+    for (; u >= 0x80; u >>= 7) {
+      buffer[n++] = char(u | 0x80);
+    }
+    buffer[n++] = char(u);
+    return n;
+  }
+};
+
+/** Reads the format produced by VarintWriter. Sets failbit on truncated
+    input or on values which do not fit in T. */
+template <typename T, typename Enable = void>
+struct VarintReader;
+
+template <typename T>
+struct VarintReader < T, typename std::enable_if < std::is_integral<T>::value &&
+    !std::is_same<T, bool>::value >::type > {
+  void operator()(std::istream& is, T& t) const {
+    auto sb = is.rdbuf();
+    const auto begin = StreamAccess::get_begin(sb);
+    std::ios::iostate state;
+    if (StreamAccess::get_end(sb) - begin > std::ptrdiff_t(max_bytes())) {
+      // Everything decode() can consume is buffered, so it is read in place
+      auto p = begin;
+      state = decode([&p] {
+        return int((unsigned char) * p++);
+      }, t);
+      StreamAccess::get_consume(sb, p);
+    } else {
+      state = decode([sb] {
+        return sb->sbumpc();
+      }, t);
+    }
+    if (state != std::ios::goodbit) {
+      is.setstate(state);
+    }
+  }
+
+ private:
+  static constexpr size_t max_bytes() {
+    return VarintWriter<T>::max_bytes();
+  }
+
+  /** Decodes bytes returned by next() until a value ends or is malformed.
+      Consumes at most max_bytes() + 1 bytes. */
+  template <typename Next>
+  static std::ios::iostate decode(Next next, T& t) {
+    typedef typename std::make_unsigned<T>::type U;
+    U u = 0;
+    for (size_t shift = 0; ; shift += 7) {
+      const auto c = next();
+      if (c == std::char_traits<char>::eof()) {
+        return std::ios::failbit | std::ios::eofbit;
+      } else if (shift >= sizeof(T) * 8 ||
+                 (shift + 7 > sizeof(T) * 8 && ((c & 0x7f) >> (sizeof(T) * 8 - shift)) != 0)) {
+        return std::ios::failbit;
+      }
+      u |= U(c & 0x7f) << shift;
+      if ((c & 0x80) == 0) {
+        break;
+      }
+    }
+    t = std::is_signed<T>::value ? T((u >> 1) ^ (U(0) - (u & 1))) : T(u);
+    return std::ios::goodbit;
+  }
+};
+
+} // namespace cpputil
+
+#endif
@@ -0,0 +1,112 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_SYSTEM_CYCLE_CLOCK_H
+#define CPPUTIL_INCLUDE_SYSTEM_CYCLE_CLOCK_H
+
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+namespace cpputil {
+
+/** A low overhead clock for timing short code regions. Where the processor
+    has an invariant time stamp counter, readings are taken with rdtsc and
+    rdtscp (tens of cycles) and converted to nanoseconds with a ratio which
+    is calibrated once against CLOCK_MONOTONIC. Elsewhere, readings come
+    from clock_gettime() and are already in nanoseconds. */
+class CycleClock {
+ public:
+  /** Reads the clock at the start of a region. The fence keeps the read from
+      being hoisted above earlier instructions. */
+  static uint64_t start() {
+#if defined(__x86_64__) || defined(__i386__)
+    if (invariant_tsc()) {
+      _mm_lfence();
+      return __rdtsc();
+    }
+#endif
+    return monotonic_ns();
+  }
+
+  /** Reads the clock at the end of a region. rdtscp waits for the region's
+      instructions to complete before reading the counter. */
+  static uint64_t stop() {
+#if defined(__x86_64__) || defined(__i386__)
+    if (invariant_tsc()) {
+      unsigned aux;
+      return __rdtscp(&aux);
+    }
+#endif
+    return monotonic_ns();
+  }
+
+  /** Returns the number of nanoseconds per tick of start() and stop(). */
+  static double ns_per_tick() {
+    static const double res = calibrate();
+    return res;
+  }
+
+  /** Converts a difference of readings to nanoseconds. */
+  static double to_ns(uint64_t ticks) {
+    return ticks * ns_per_tick();
+  }
+
+  /** Returns true if readings come from the time stamp counter. */
+  static bool invariant_tsc() {
+    static const bool res = detect_invariant_tsc();
+    return res;
+  }
+
+ private:
+  static uint64_t monotonic_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+  }
+
+  static bool detect_invariant_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned eax, ebx, ecx, edx;
+    if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0 || eax < 0x80000007) {
+      return false;
+    }
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    return (edx >> 8) & 1;
+#else
+    return false;
+#endif
+  }
+
+  /** Spins for about 10ms and compares the two clocks. */
+  static double calibrate() {
+    if (!invariant_tsc()) {
+      return 1.0;
+    }
+    const auto ns0 = monotonic_ns();
+    const auto t0 = start();
+    uint64_t ns1 = ns0;
+    while ((ns1 = monotonic_ns()) - ns0 < 10000000);
+    const auto t1 = stop();
+    return double(ns1 - ns0) / (t1 - t0);
+  }
+};
+
+} // namespace cpputil
+
+#endif
@@ -0,0 +1,129 @@
+// Copyright 2014 eric schkufza
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CPPUTIL_INCLUDE_SYSTEM_MAPPED_FILE_H
+#define CPPUTIL_INCLUDE_SYSTEM_MAPPED_FILE_H
+
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace cpputil {
+
+/** A read-only memory mapping of an entire file. Pages are faulted in by the
+    kernel as they are touched, so opening even a very large file costs a
+    handful of system calls and no copying. */
+class MappedFile {
+ public:
+  MappedFile() : data_(nullptr), size_(0), is_open_(false) { }
+  explicit MappedFile(const std::string& path) : MappedFile() {
+    open(path);
+  }
+  MappedFile(const MappedFile& rhs) = delete;
+  MappedFile(MappedFile&& rhs) : MappedFile() {
+    swap(rhs);
+  }
+  MappedFile& operator=(MappedFile rhs) {
+    swap(rhs);
+    return *this;
+  }
+  ~MappedFile() {
+    close();
+  }
+
+  /** Maps path, replacing any current mapping. Returns false on failure. */
+  bool open(const std::string& path) {
+    close();
+    const auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+      ::close(fd);
+      return false;
+    }
+    // A zero length mapping is an error, but an empty file is not
+    if (st.st_size > 0) {
+      void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p == MAP_FAILED) {
+        ::close(fd);
+        return false;
+      }
+      data_ = (const char*)p;
+      size_ = st.st_size;
+    }
+    ::close(fd);
+    return is_open_ = true;
+  }
+
+  /** Releases the current mapping. */
+  void close() {
+    if (data_ != nullptr) {
+      munmap((void*)data_, size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    is_open_ = false;
+  }
+
+  /** Advises the kernel that the mapping will be read front to back. */
+  void sequential() const {
+    if (data_ != nullptr) {
+      madvise((void*)data_, size_, MADV_SEQUENTIAL);
+    }
+  }
+
+  bool is_open() const {
+    return is_open_;
+  }
+  const char* data() const {
+    return data_;
+  }
+  size_t size() const {
+    return size_;
+  }
+  const char* begin() const {
+    return data_;
+  }
+  const char* end() const {
+    return data_ + size_;
+  }
+
+  void swap(MappedFile& rhs) {
+    std::swap(data_, rhs.data_);
+    std::swap(size_, rhs.size_);
+    std::swap(is_open_, rhs.is_open_);
+  }
+
+ private:
+  const char* data_;
+  size_t size_;
+  bool is_open_;
+};
+
+} // namespace cpputil
+
+namespace std {
+
+inline void swap(cpputil::MappedFile& lhs, cpputil::MappedFile& rhs) {
+  lhs.swap(rhs);
+}
+
+} // namespace std
+
+#endif